@@ -0,0 +1,227 @@
+// main.cpp : Microbenchmarks of the lexer, to be run on a Release build.
+// Bench [file.d.ts...] times the keyword lookup on the identifiers of the
+// files, then the scan kernels of every supported instruction set.
+//
+
+#include "stdafx.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace nope::dts::parser;
+
+namespace
+{
+	// How the keywords were looked up before the perfect hash
+	std::size_t linearFind(std::string_view id)
+	{
+		for (std::size_t i = 0; i < keyword::count; ++i)
+		{
+			if (keyword::list[i].name == id)
+			{
+				return i;
+			}
+		}
+		return keyword::count;
+	}
+
+	// Best time of a few runs, in nanoseconds per item
+	template<typename Run>
+	double measure(std::size_t items, Run run)
+	{
+		double best = 0;
+
+		for (int i = 0; i < 5; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+
+			run();
+
+			double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+			best = i == 0 || elapsed < best ? elapsed : best;
+		}
+		return best / items;
+	}
+
+	// The identifiers of the files, or every keyword among common names if none is given
+	std::vector<std::string> identifiers(int ac, char **av)
+	{
+		std::vector<std::string> ids;
+
+		for (int i = 1; i < ac; ++i)
+		{
+			Tokenizer tokenizer(Source(av[i]), TriviaMode::FAST);
+
+			for (Token token = tokenizer.next(); token.type != TokenType::END_OF_FILE; token = tokenizer.next())
+			{
+				if (token.type == TokenType::ID || keyword::find(tokenizer.value(token)) != keyword::count)
+				{
+					ids.emplace_back(tokenizer.value(token));
+				}
+			}
+		}
+		if (ids.empty())
+		{
+			for (auto const &k : keyword::list)
+			{
+				ids.emplace_back(k.name);
+			}
+			for (char const *name : { "string", "number", "boolean", "any", "void", "Promise", "Array",
+				"length", "value", "options", "callback", "T", "K", "EventEmitter", "x" })
+			{
+				ids.emplace_back(name);
+			}
+		}
+		return ids;
+	}
+
+	char const *name(scan::Isa isa)
+	{
+		switch (isa)
+		{
+		case scan::Isa::AVX2:
+			return "AVX2";
+		case scan::Isa::SSE2:
+			return "SSE2";
+		default:
+			return "scalar";
+		}
+	}
+
+	// Runs of a token class, of a length picked in [1, longest], each followed by a byte stopping it
+	std::string runs(std::string_view alphabet, std::size_t longest, std::string_view stop)
+	{
+		std::string text;
+		std::uint32_t seed = 1;
+
+		while (text.size() < (std::size_t(1) << 20))
+		{
+			seed = seed * 1664525 + 1013904223;
+
+			std::size_t length = (seed >> 8) % longest + 1;
+
+			for (std::size_t i = 0; i < length; ++i)
+			{
+				text += alphabet[((seed >> 16) + i) % alphabet.size()];
+			}
+			text += stop;
+		}
+		return text;
+	}
+
+	struct TokenClass
+	{
+		char const *name;
+		std::string text;
+		// Size of what stops a run
+		std::size_t stop;
+		std::size_t (*scan)(char const *data, std::size_t begin, std::size_t end);
+	};
+
+	std::size_t findQuote(char const *data, std::size_t begin, std::size_t end)
+	{
+		return scan::findStringStop(data, begin, end, '"');
+	}
+
+	void benchKeywords(std::vector<std::string> const &ids)
+	{
+		std::size_t const rounds = 20000000 / ids.size() + 1;
+		std::size_t const items = rounds * ids.size();
+		std::size_t keywords = 0;
+		std::size_t checksum = 0;
+
+		for (auto const &id : ids)
+		{
+			if (keyword::find(id) != linearFind(id))
+			{
+				std::cerr << "Mismatch on " << id << std::endl;
+				std::exit(1);
+			}
+			keywords += keyword::find(id) != keyword::count;
+		}
+
+		double hashed = measure(items, [&]()
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				for (auto const &id : ids)
+				{
+					checksum += keyword::find(id);
+				}
+			}
+		});
+		double linear = measure(items, [&]()
+		{
+			for (std::size_t r = 0; r < rounds; ++r)
+			{
+				for (auto const &id : ids)
+				{
+					checksum += linearFind(id);
+				}
+			}
+		});
+
+		std::cout << ids.size() << " identifiers, " << keywords << " keywords" << std::endl
+			<< "keyword::find  " << hashed << " ns/lookup" << std::endl
+			<< "linear scan    " << linear << " ns/lookup" << std::endl
+			<< "(checksum " << checksum << ")" << std::endl;
+	}
+
+	void benchKernels()
+	{
+		TokenClass classes[] = {
+			{ "blank", runs(" \t", 16, "x"), 1, scan::skipSpace },
+			{ "identifier", runs("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$", 24, " "), 1, scan::skipIdentifier },
+			{ "comment", runs("abcdefghij klmnopqrst, uvwxyz.\n", 200, "*/"), 2, scan::findCommentEnd },
+			{ "string", runs("abcdefghij klmnopqrst./-", 40, "\""), 1, findQuote }
+		};
+		scan::Isa const best = scan::isa();
+
+		std::cout << "scan kernels, MB/s" << std::endl;
+		for (auto isa : { scan::Isa::SCALAR, scan::Isa::SSE2, scan::Isa::AVX2 })
+		{
+			if (static_cast<int>(isa) > static_cast<int>(best))
+			{
+				break;
+			}
+			scan::force(isa);
+			std::cout << "  " << name(isa);
+			for (auto const &c : classes)
+			{
+				char const *data = c.text.data();
+				std::size_t const end = c.text.size();
+				double ns = measure(end, [&]()
+				{
+					for (std::size_t at = 0; at < end; at = c.scan(data, at, end) + c.stop)
+					{
+					}
+				});
+
+				std::cout << "  " << c.name << " " << 1000 / ns;
+			}
+			std::cout << std::endl;
+		}
+		scan::force(best);
+	}
+}
+
+int main(int ac, char **av)
+{
+	std::vector<std::string> ids;
+
+	try
+	{
+		ids = identifiers(ac, av);
+	}
+	catch (std::exception const &e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 2;
+	}
+	benchKeywords(ids);
+	benchKernels();
+	return 0;
+}
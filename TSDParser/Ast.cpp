@@ -0,0 +1,492 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <utility>
+
+namespace nope::dts::parser
+{
+	Node::Node() :
+		m_ast(nullptr),
+		m_id(Ast::none)
+	{
+	}
+
+	Node::Node(Ast &ast, NodeId id) :
+		m_ast(&ast),
+		m_id(id)
+	{
+	}
+
+	NodeId Node::id() const
+	{
+		return m_id;
+	}
+
+	Ast & Node::ast() const
+	{
+		return *m_ast;
+	}
+
+	TokenType Node::type() const
+	{
+		return m_ast->type(m_id);
+	}
+
+	void Node::setType(TokenType type)
+	{
+		m_ast->setType(m_id, type);
+	}
+
+	std::string_view Node::value() const
+	{
+		return m_ast->value(m_id);
+	}
+
+	Symbol Node::symbol() const
+	{
+		return m_ast->symbol(m_id);
+	}
+
+	bool Node::isTerminal() const
+	{
+		return parser::isTerminal(this->type());
+	}
+
+	bool Node::isKeyword() const
+	{
+		return parser::isKeyword(this->type());
+	}
+
+	bool Node::isReserved() const
+	{
+		return parser::isReserved(this->type());
+	}
+
+	Node & Node::operator<<(Node const & children)
+	{
+		m_ast->append(m_id, children.m_id);
+
+		return *this;
+	}
+
+	Node & Node::operator<<(Token const & token)
+	{
+		m_ast->append(m_id, m_ast->create(token));
+
+		return *this;
+	}
+
+	Node Node::operator[](std::size_t i) const
+	{
+		return Node(*m_ast, m_ast->child(m_id, i));
+	}
+
+	std::size_t Node::size() const
+	{
+		return m_ast->childCount(m_id);
+	}
+
+	Node Node::last() const
+	{
+		return Node(*m_ast, m_ast->lastChild(m_id));
+	}
+
+	std::string Node::json() const
+	{
+		std::string output;
+
+		{
+			StringSink sink(output);
+
+			JsonEmitter(sink).write(*m_ast, m_id);
+		}
+		return output;
+	}
+
+	std::string Node::code() const
+	{
+		std::string output;
+
+		{
+			StringSink sink(output);
+
+			CodeEmitter(sink).write(*m_ast, m_id);
+		}
+		return output;
+	}
+
+	std::string Node::xml() const
+	{
+		std::string output;
+
+		{
+			StringSink sink(output);
+
+			XmlEmitter(sink).write(*m_ast, m_id);
+		}
+		return output;
+	}
+
+	Ast::Ast() :
+		m_source(),
+		m_root(none),
+		m_live(0),
+		m_counted(false),
+		m_type(),
+		m_offset(),
+		m_length(),
+		m_symbol(),
+		m_firstChild(),
+		m_nextSibling(),
+		m_lastChild(),
+		m_childCount()
+	{
+	}
+
+	/// <summary>
+	/// Drop every node and prepare the arena for a new tree over <paramref name="source"/>.
+	/// </summary>
+	/// <param name="source">The text the terminal values refer to.</param>
+	/// <param name="capacity">Number of nodes to reserve room for.</param>
+	void Ast::reset(std::string_view source, std::size_t capacity)
+	{
+		m_source = source;
+		m_root = none;
+		m_live = 0;
+		m_counted = false;
+
+		m_type.clear();
+		m_offset.clear();
+		m_length.clear();
+		m_symbol.clear();
+		m_firstChild.clear();
+		m_nextSibling.clear();
+		m_lastChild.clear();
+		m_childCount.clear();
+
+		m_type.reserve(capacity);
+		m_offset.reserve(capacity);
+		m_length.reserve(capacity);
+		m_symbol.reserve(capacity);
+		m_firstChild.reserve(capacity);
+		m_nextSibling.reserve(capacity);
+		m_lastChild.reserve(capacity);
+		m_childCount.reserve(capacity);
+	}
+
+	/// <summary>
+	/// Create a detached node without value.
+	/// </summary>
+	NodeId Ast::create(TokenType type)
+	{
+		NodeId id = static_cast<NodeId>(m_type.size());
+
+		m_type.push_back(type);
+		m_offset.push_back(npos);
+		m_length.push_back(0);
+		m_symbol.push_back(0);
+		m_firstChild.push_back(none);
+		m_nextSibling.push_back(none);
+		m_lastChild.push_back(none);
+		m_childCount.push_back(0);
+
+		return id;
+	}
+
+	/// <summary>
+	/// Create a detached terminal node whose value is the token's text.
+	/// </summary>
+	NodeId Ast::create(Token const & token)
+	{
+		NodeId id = this->create(token.type);
+
+		m_offset[id] = token.offset;
+		m_length[id] = token.length;
+		m_symbol[id] = token.symbol;
+
+		return id;
+	}
+
+	/// <summary>
+	/// Attach <paramref name="child"/> as the last child of <paramref name="parent"/>,
+	/// extending the span of the parent up to the end of the child.
+	/// </summary>
+	void Ast::append(NodeId parent, NodeId child)
+	{
+		NOPE_DTS_TRACE_NODE(m_type[parent], m_type[child], this->value(child));
+
+		if (m_offset[child] != npos)
+		{
+			if (m_offset[parent] == npos)
+			{
+				m_offset[parent] = m_offset[child];
+			}
+			m_length[parent] = m_offset[child] + m_length[child] - m_offset[parent];
+		}
+
+		if (m_lastChild[parent] == none)
+		{
+			m_firstChild[parent] = child;
+		}
+		else
+		{
+			m_nextSibling[m_lastChild[parent]] = child;
+		}
+		m_lastChild[parent] = child;
+		++m_childCount[parent];
+	}
+
+	/// <summary>
+	/// Put <paramref name="node"/> in place of the child <paramref name="old"/>
+	/// of <paramref name="parent"/>. The old subtree stays in the arena,
+	/// unreachable, until <see cref="compact"/>.
+	/// </summary>
+	/// <param name="previous">The sibling before old, or none if it is the first child.</param>
+	void Ast::replace(NodeId parent, NodeId previous, NodeId old, NodeId node)
+	{
+		// The whole tree is only counted once, then each replace counts what it swaps
+		if (!m_counted)
+		{
+			m_live = this->count(m_root);
+			m_counted = true;
+		}
+		m_live = m_live + this->count(node) - this->count(old);
+
+		m_nextSibling[node] = m_nextSibling[old];
+		if (previous == none)
+		{
+			m_firstChild[parent] = node;
+		}
+		else
+		{
+			m_nextSibling[previous] = node;
+		}
+		if (m_lastChild[parent] == old)
+		{
+			m_lastChild[parent] = node;
+		}
+	}
+
+	/// <summary>
+	/// Move the tree onto an edited source, where the text before
+	/// <paramref name="from"/> is unchanged and the text after it moved by
+	/// <paramref name="delta"/> bytes. The spans ending after from are moved
+	/// or stretched accordingly; those ending inside the edit are left as is.
+	/// Only the nodes reachable from the root are visited, and not the
+	/// subtrees ending before from.
+	/// </summary>
+	void Ast::rebase(std::string_view source, std::uint32_t from, std::int64_t delta)
+	{
+		std::vector<NodeId> stack;
+
+		m_source = source;
+		if (m_root != none)
+		{
+			stack.push_back(m_root);
+		}
+		while (!stack.empty())
+		{
+			NodeId id = stack.back();
+
+			stack.pop_back();
+			// Without terminal, or before the edit: so is everything below
+			if (m_offset[id] == npos || m_offset[id] + m_length[id] <= from)
+			{
+				continue;
+			}
+			if (m_offset[id] >= from)
+			{
+				m_offset[id] = static_cast<std::uint32_t>(m_offset[id] + delta);
+			}
+			else
+			{
+				m_length[id] = static_cast<std::uint32_t>(m_length[id] + delta);
+			}
+			for (NodeId c = m_firstChild[id]; c != none; c = m_nextSibling[c])
+			{
+				stack.push_back(c);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Tell whether the unreachable nodes left by <see cref="replace"/>
+	/// outnumber the reachable ones.
+	/// </summary>
+	bool Ast::sparse() const
+	{
+		return m_counted && m_type.size() - m_live > m_live;
+	}
+
+	/// <summary>
+	/// Drop the unreachable nodes, renumbering the others in preorder.
+	/// Invalidates every NodeId but the root's, which is read again.
+	/// </summary>
+	void Ast::compact()
+	{
+		Ast packed;
+		// Node to copy, and the copy of its parent
+		std::vector<std::pair<NodeId, NodeId>> stack;
+
+		packed.reset(m_source, m_counted ? m_live : m_type.size());
+		if (m_root != none)
+		{
+			stack.emplace_back(m_root, none);
+		}
+		while (!stack.empty())
+		{
+			auto [old, parent] = stack.back();
+			NodeId id = packed.create(m_type[old]);
+			std::size_t const children = stack.size() - 1;
+
+			stack.pop_back();
+			packed.m_offset[id] = m_offset[old];
+			packed.m_length[id] = m_length[old];
+			packed.m_symbol[id] = m_symbol[old];
+			if (parent == none)
+			{
+				packed.m_root = id;
+			}
+			else
+			{
+				if (packed.m_lastChild[parent] == none)
+				{
+					packed.m_firstChild[parent] = id;
+				}
+				else
+				{
+					packed.m_nextSibling[packed.m_lastChild[parent]] = id;
+				}
+				packed.m_lastChild[parent] = id;
+				++packed.m_childCount[parent];
+			}
+			// Pushed backwards, so that the first child is copied next
+			for (NodeId c = m_firstChild[old]; c != none; c = m_nextSibling[c])
+			{
+				stack.emplace_back(c, id);
+			}
+			std::reverse(stack.begin() + children, stack.end());
+		}
+		packed.m_live = packed.m_type.size();
+		packed.m_counted = true;
+		*this = std::move(packed);
+	}
+
+	// Number of nodes of a subtree
+	std::size_t Ast::count(NodeId id) const
+	{
+		std::vector<NodeId> stack;
+		std::size_t n = 0;
+
+		if (id != none)
+		{
+			stack.push_back(id);
+		}
+		while (!stack.empty())
+		{
+			NodeId node = stack.back();
+
+			stack.pop_back();
+			++n;
+			for (NodeId c = m_firstChild[node]; c != none; c = m_nextSibling[c])
+			{
+				stack.push_back(c);
+			}
+		}
+		return n;
+	}
+
+	std::string_view Ast::source() const
+	{
+		return m_source;
+	}
+
+	std::size_t Ast::size() const
+	{
+		return m_type.size();
+	}
+
+	NodeId Ast::root() const
+	{
+		return m_root;
+	}
+
+	void Ast::setRoot(NodeId id)
+	{
+		m_root = id;
+		m_counted = false;
+	}
+
+	TokenType Ast::type(NodeId id) const
+	{
+		return m_type[id];
+	}
+
+	void Ast::setType(NodeId id, TokenType type)
+	{
+		m_type[id] = type;
+	}
+
+	/// <summary>
+	/// Get the source text a node spans.
+	/// </summary>
+	std::string_view Ast::value(NodeId id) const
+	{
+		return m_offset[id] == npos ? std::string_view() : m_source.substr(m_offset[id], m_length[id]);
+	}
+
+	/// <summary>
+	/// Get the offset of the first terminal of a node, or npos if it has none.
+	/// </summary>
+	std::uint32_t Ast::offset(NodeId id) const
+	{
+		return m_offset[id];
+	}
+
+	std::uint32_t Ast::length(NodeId id) const
+	{
+		return m_length[id];
+	}
+
+	/// <summary>
+	/// Get the interned name of an identifier or keyword node, 0 for the others.
+	/// </summary>
+	Symbol Ast::symbol(NodeId id) const
+	{
+		return m_symbol[id];
+	}
+
+	NodeId Ast::firstChild(NodeId id) const
+	{
+		return m_firstChild[id];
+	}
+
+	NodeId Ast::nextSibling(NodeId id) const
+	{
+		return m_nextSibling[id];
+	}
+
+	NodeId Ast::lastChild(NodeId id) const
+	{
+		return m_lastChild[id];
+	}
+
+	std::uint32_t Ast::childCount(NodeId id) const
+	{
+		return m_childCount[id];
+	}
+
+	/// <summary>
+	/// Get the <paramref name="index"/>-th child of a node, walking its siblings:
+	/// in O(index), so not to be called in a loop over the children.
+	/// </summary>
+	NodeId Ast::child(NodeId id, std::size_t index) const
+	{
+		NodeId c = m_firstChild[id];
+
+		while (index-- != 0)
+		{
+			c = m_nextSibling[c];
+		}
+		return c;
+	}
+}
@@ -0,0 +1,137 @@
+#ifndef NOPE_DTS_PARSER_AST_HPP_
+# define NOPE_DTS_PARSER_AST_HPP_
+
+# include <cstdint>
+# include <string>
+# include <string_view>
+# include <vector>
+# include "Token.hpp"
+
+namespace nope::dts::parser
+{
+	using NodeId = std::uint32_t;
+
+	class Ast;
+
+	/// <summary>
+	/// Lightweight handle on a node stored in an <see cref="Ast"/>.
+	/// Copying a node copies the handle, never the subtree.
+	/// </summary>
+	class Node
+	{
+	public:
+		Node();
+		Node(Ast &ast, NodeId id);
+		Node(Node const &that) = default;
+		Node(Node &&that) = default;
+
+		~Node() noexcept = default;
+
+		Node &operator=(Node const &that) = default;
+		Node &operator=(Node &&that) = default;
+
+		NodeId id() const;
+		Ast &ast() const;
+
+		TokenType type() const;
+		void setType(TokenType type);
+		std::string_view value() const;
+		Symbol symbol() const;
+
+		bool isTerminal() const;
+		bool isKeyword() const;
+		bool isReserved() const;
+
+		Node &operator<<(Node const &children);
+		Node &operator<<(Token const &token);
+
+		// O(i), the siblings are walked: loop with firstChild/nextSibling instead
+		Node operator[](std::size_t i) const;
+
+		std::size_t size() const;
+
+		Node last() const;
+
+		std::string json() const;
+		std::string code() const;
+		std::string xml() const;
+
+	private:
+		Ast *m_ast;
+		NodeId m_id;
+	};
+
+	/// <summary>
+	/// Arena holding every node of a syntax tree in parallel arrays.
+	/// Children are linked through first-child/next-sibling indexes, and the
+	/// values are offset/length pairs into the source, so building a tree
+	/// only grows a handful of vectors instead of allocating every node.
+	/// Every node spans the source from its first to its last terminal; a
+	/// node without terminal has an offset of npos.
+	/// </summary>
+	class Ast
+	{
+	public:
+		static constexpr NodeId none = ~NodeId(0);
+		static constexpr std::uint32_t npos = ~std::uint32_t(0);
+
+		Ast();
+		Ast(Ast const &that) = default;
+		Ast(Ast &&that) = default;
+
+		~Ast() noexcept = default;
+
+		Ast &operator=(Ast const &that) = default;
+		Ast &operator=(Ast &&that) = default;
+
+		void reset(std::string_view source, std::size_t capacity = 0);
+
+		NodeId create(TokenType type);
+		NodeId create(Token const &token);
+		void append(NodeId parent, NodeId child);
+		void replace(NodeId parent, NodeId previous, NodeId old, NodeId node);
+		void rebase(std::string_view source, std::uint32_t from, std::int64_t delta);
+		bool sparse() const;
+		void compact();
+
+		std::string_view source() const;
+		std::size_t size() const;
+
+		NodeId root() const;
+		void setRoot(NodeId id);
+
+		TokenType type(NodeId id) const;
+		void setType(NodeId id, TokenType type);
+		std::string_view value(NodeId id) const;
+		std::uint32_t offset(NodeId id) const;
+		std::uint32_t length(NodeId id) const;
+		Symbol symbol(NodeId id) const;
+
+		NodeId firstChild(NodeId id) const;
+		NodeId nextSibling(NodeId id) const;
+		NodeId lastChild(NodeId id) const;
+		std::uint32_t childCount(NodeId id) const;
+		// O(index), see Node::operator[]
+		NodeId child(NodeId id, std::size_t index) const;
+
+	private:
+		std::size_t count(NodeId id) const;
+
+		std::string_view m_source;
+		NodeId m_root;
+		// Nodes reachable from the root, only counted from the first replace on
+		std::size_t m_live;
+		bool m_counted;
+
+		std::vector<TokenType> m_type;
+		std::vector<std::uint32_t> m_offset;
+		std::vector<std::uint32_t> m_length;
+		std::vector<Symbol> m_symbol;
+		std::vector<NodeId> m_firstChild;
+		std::vector<NodeId> m_nextSibling;
+		std::vector<NodeId> m_lastChild;
+		std::vector<std::uint32_t> m_childCount;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_AST_HPP_
@@ -0,0 +1,141 @@
+#ifndef NOPE_DTS_PARSER_CHARSET_HPP_
+# define NOPE_DTS_PARSER_CHARSET_HPP_
+
+# include <array>
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+# include "Token.hpp"
+
+/// <summary>
+/// Byte classification tables used by the Tokenizer, built at compile time.
+/// Unlike the &lt;cctype&gt; functions they are locale independent and are
+/// a single load for any byte, including the non-ASCII ones.
+/// </summary>
+namespace nope::dts::parser::charset
+{
+	enum class CharClass : std::uint8_t
+	{
+		OTHER,
+		SPACE,
+		NEWLINE,
+		ID_START,
+		DIGIT,
+		QUOTE,
+		SLASH,
+		PUNCTUATION
+	};
+
+	constexpr std::array<CharClass, 256> buildClasses()
+	{
+		std::array<CharClass, 256> table{};
+
+		for (int c = 'a'; c <= 'z'; ++c)
+		{
+			table[c] = CharClass::ID_START;
+			table[c - 'a' + 'A'] = CharClass::ID_START;
+		}
+		for (int c = '0'; c <= '9'; ++c)
+		{
+			table[c] = CharClass::DIGIT;
+		}
+		table['_'] = CharClass::ID_START;
+		table['$'] = CharClass::ID_START;
+
+		table[' '] = CharClass::SPACE;
+		table['\t'] = CharClass::SPACE;
+		table['\r'] = CharClass::SPACE;
+		table['\v'] = CharClass::SPACE;
+		table['\f'] = CharClass::SPACE;
+		table['\n'] = CharClass::NEWLINE;
+
+		table['"'] = CharClass::QUOTE;
+		table['\''] = CharClass::QUOTE;
+		table['/'] = CharClass::SLASH;
+
+		for (unsigned char c : std::string_view(":;.,\\?*(){}[]=|<>&"))
+		{
+			table[c] = CharClass::PUNCTUATION;
+		}
+		return table;
+	}
+
+	constexpr std::array<TokenType, 256> buildPunctuation()
+	{
+		std::array<TokenType, 256> table{};
+
+		for (auto &t : table)
+		{
+			t = TokenType::UNKNOWN;
+		}
+		table[':'] = TokenType::P_COLON;
+		table[';'] = TokenType::P_SEMICOLON;
+		table['.'] = TokenType::P_DOT;
+		table[','] = TokenType::P_COMMA;
+		table['/'] = TokenType::P_SLASH;
+		table['\\'] = TokenType::P_ANTISLASH;
+		table['?'] = TokenType::P_QUESTION;
+		table['*'] = TokenType::P_STAR;
+		table['('] = TokenType::P_OPEN_PAR;
+		table[')'] = TokenType::P_CLOSE_PAR;
+		table['{'] = TokenType::P_OPEN_BRACE;
+		table['}'] = TokenType::P_CLOSE_BRACE;
+		table['['] = TokenType::P_OPEN_BRACKET;
+		table[']'] = TokenType::P_CLOSE_BRACKET;
+		table['='] = TokenType::P_EQUAL;
+		table['|'] = TokenType::P_VERTICAL_BAR;
+		table['<'] = TokenType::P_GREATER_THAN;
+		table['>'] = TokenType::P_LESS_THAN;
+		table['&'] = TokenType::P_AMPERSAND;
+		return table;
+	}
+
+	constexpr std::array<CharClass, 256> classes = buildClasses();
+	constexpr std::array<TokenType, 256> punctuation = buildPunctuation();
+
+	inline CharClass classOf(char c)
+	{
+		return classes[static_cast<unsigned char>(c)];
+	}
+
+	inline bool isSpace(char c)
+	{
+		return classOf(c) == CharClass::SPACE;
+	}
+
+	inline bool isDigit(char c)
+	{
+		return classOf(c) == CharClass::DIGIT;
+	}
+
+	inline bool isIdentifier(char c)
+	{
+		CharClass cls = classOf(c);
+
+		return cls == CharClass::ID_START || cls == CharClass::DIGIT;
+	}
+
+	/// <summary>
+	/// Get the length of the UTF-8 sequence starting with <paramref name="c"/>, 1 if it is not a valid lead byte.
+	/// </summary>
+	inline std::size_t sequenceLength(char c)
+	{
+		auto u = static_cast<unsigned char>(c);
+
+		if (u >= 0xF0 && u <= 0xF7)
+		{
+			return 4;
+		}
+		if (u >= 0xE0)
+		{
+			return u <= 0xEF ? 3 : 1;
+		}
+		if (u >= 0xC2)
+		{
+			return 2;
+		}
+		return 1;
+	}
+}
+
+#endif // !NOPE_DTS_PARSER_CHARSET_HPP_
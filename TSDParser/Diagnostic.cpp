@@ -0,0 +1,12 @@
+#include "stdafx.h"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Format the diagnostic as "file:line:column Error: message".
+	/// </summary>
+	std::string Diagnostic::str() const
+	{
+		return file + ':' + std::to_string(line) + ':' + std::to_string(column) + " Error: " + message;
+	}
+}
@@ -0,0 +1,26 @@
+#ifndef NOPE_DTS_PARSER_DIAGNOSTIC_HPP_
+# define NOPE_DTS_PARSER_DIAGNOSTIC_HPP_
+
+# include <cstddef>
+# include <cstdint>
+# include <string>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// A syntax error found in an input, located both by byte offset and by
+	/// line and column, the latter starting at 1.
+	/// </summary>
+	struct Diagnostic
+	{
+		std::string file;
+		std::uint32_t offset = 0;
+		std::size_t line = 0;
+		std::size_t column = 0;
+		std::string message;
+
+		std::string str() const;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_DIAGNOSTIC_HPP_
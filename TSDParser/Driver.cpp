@@ -0,0 +1,385 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Driver"/> class.
+	/// </summary>
+	Driver::Driver(Options const &options) :
+		m_options(options),
+		m_cache(),
+		m_interner(),
+		m_contents(),
+		m_results(),
+		m_mutex(),
+		m_done()
+	{
+	}
+
+	Driver::~Driver() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Parse every file and write the results.
+	/// </summary>
+	/// <returns>0 if every file parsed, 1 otherwise.</returns>
+	int Driver::run(std::vector<std::string> const &files)
+	{
+		FdSink output(m_options.output);
+		std::vector<Input> inputs(files.size());
+		int status = 0;
+
+		if (!m_options.cache.empty())
+		{
+			m_cache = std::make_unique<ParseCache>(m_options.cache, m_options.cacheSize);
+		}
+		m_interner = std::make_unique<Interner>();
+		m_contents.clear();
+		m_results.clear();
+		m_results.resize(files.size());
+		for (std::size_t i = 0; i < files.size(); ++i)
+		{
+			m_results[i].filename = files[i];
+		}
+
+		ThreadPool pool(std::min(m_options.jobs != 0 ? m_options.jobs : std::thread::hardware_concurrency(),
+			std::max<std::size_t>(files.size(), 1)));
+
+		for (std::size_t i = 0; i < files.size(); ++i)
+		{
+			Input &input = inputs[i];
+
+			pool.submit([this, &files, &input, i] { this->read(files[i], input); });
+		}
+		pool.wait();
+		this->group(inputs);
+
+		for (std::size_t i : this->schedule())
+		{
+			Content &content = m_contents[i];
+
+			pool.submit([this, &content] { this->parse(content); });
+		}
+
+		for (auto &result : m_results)
+		{
+			Content &content = m_contents[result.content];
+
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				m_done.wait(lock, [&content] { return content.done; });
+			}
+
+			output.write(content.output);
+			if (!content.ok)
+			{
+				// Keep the diagnostics in line with the output
+				output.flush();
+				std::cerr << this->describe(result) << std::endl;
+				status = 1;
+			}
+			// Written already by every input having it, no need to keep it until the end of the batch
+			if (--content.users == 0)
+			{
+				std::string().swap(content.output);
+			}
+		}
+
+		if (m_cache)
+		{
+			ParseCache::Stats stats;
+
+			m_cache->evict();
+			stats = m_cache->stats();
+			std::cerr << "Cache: " << stats.hits << " hits, " << stats.misses << " misses, "
+				<< stats.stored << " stored, " << stats.evicted << " evicted" << std::endl;
+		}
+		m_interner.reset();
+		return status;
+	}
+
+	/// <summary>
+	/// Read and hash one input. Runs on a worker.
+	/// A mapped file is released right away, the parse maps it again.
+	/// </summary>
+	void Driver::read(std::string const &filename, Input &input) const
+	{
+		try
+		{
+			input.source.emplace(filename);
+			input.size = input.source->size();
+			input.hash = hash::of(input.source->data());
+			if (input.source->mapped())
+			{
+				input.source.reset();
+			}
+		}
+		catch (std::exception const &e)
+		{
+			input.source.reset();
+			input.error = e.what();
+		}
+	}
+
+	/// <summary>
+	/// Gather the inputs by content, and give each result its content.
+	/// The inputs with the same hash and size are compared byte for byte
+	/// before sharing a parse, a collision must not give a file the tree of
+	/// another.
+	/// </summary>
+	void Driver::group(std::vector<Input> &inputs)
+	{
+		std::unordered_map<std::uint64_t, std::vector<std::size_t>> known;
+
+		// Taking references to the contents from now on
+		m_contents.reserve(inputs.size());
+		for (std::size_t i = 0; i < inputs.size(); ++i)
+		{
+			Input &input = inputs[i];
+			Result &result = m_results[i];
+
+			if (!input.error.empty())
+			{
+				Content &content = m_contents.emplace_back();
+
+				content.filename = result.filename;
+				content.error = std::move(input.error);
+				content.done = true;
+				content.users = 1;
+				result.content = m_contents.size() - 1;
+				continue;
+			}
+
+			auto &candidates = known[input.hash];
+			auto same = std::find_if(candidates.begin(), candidates.end(), [this, &input, &result](std::size_t c)
+			{
+				return m_contents[c].size == input.size && this->equal(m_contents[c], input, result.filename);
+			});
+
+			if (same != candidates.end())
+			{
+				result.content = *same;
+				++m_contents[*same].users;
+				input.source.reset();
+				continue;
+			}
+
+			Content &content = m_contents.emplace_back();
+
+			content.filename = result.filename;
+			content.size = input.size;
+			content.hash = input.hash;
+			content.users = 1;
+			content.source = std::move(input.source);
+			input.source.reset();
+			result.content = m_contents.size() - 1;
+			candidates.push_back(result.content);
+		}
+	}
+
+	/// <summary>
+	/// Whether an input has the bytes of a content of the same hash and size.
+	/// The files were unmapped once hashed and are mapped again for this,
+	/// which only happens for duplicates. An input that cannot be read
+	/// again is not taken as a duplicate, its own parse reports why.
+	/// </summary>
+	bool Driver::equal(Content const &content, Input const &input, std::string const &filename) const
+	{
+		try
+		{
+			std::optional<Source> mappedContent;
+			std::optional<Source> mappedInput;
+			std::string_view left = content.source ? content.source->data() : mappedContent.emplace(content.filename).data();
+			std::string_view right = input.source ? input.source->data() : mappedInput.emplace(filename).data();
+
+			return left == right;
+		}
+		catch (std::exception const &)
+		{
+			return false;
+		}
+	}
+
+	/// <summary>
+	/// Get the order to parse the contents in: largest first, so that a big file
+	/// does not start last and keep a single worker busy at the end of the batch.
+	/// The contents that could not be read are left out.
+	/// </summary>
+	std::vector<std::size_t> Driver::schedule() const
+	{
+		std::vector<std::pair<std::size_t, std::size_t>> sizes;
+		std::vector<std::size_t> order;
+
+		sizes.reserve(m_contents.size());
+		for (std::size_t i = 0; i < m_contents.size(); ++i)
+		{
+			if (!m_contents[i].done)
+			{
+				sizes.emplace_back(m_contents[i].size, i);
+			}
+		}
+		std::stable_sort(sizes.begin(), sizes.end(), [](auto const &l, auto const &r) { return l.first > r.first; });
+
+		order.reserve(sizes.size());
+		for (auto const &size : sizes)
+		{
+			order.push_back(size.second);
+		}
+		return order;
+	}
+
+	/// <summary>
+	/// Parse one content and fill its result. Runs on a worker.
+	/// </summary>
+	void Driver::parse(Content &content)
+	{
+		// One parser per worker, reused for every file it parses
+		static thread_local std::optional<Parser> parser;
+		// Tree unpacked from the cache, reused likewise
+		static thread_local Ast cached;
+
+		try
+		{
+			Source source = content.source ? std::move(*content.source) : Source(content.filename);
+			std::unique_ptr<ParseCache::Entry> entry;
+			std::uint64_t key = 0;
+
+			content.source.reset();
+			// Mapped again since it was hashed, the file may have changed in between
+			if (source.size() != content.size || hash::of(source.data()) != content.hash)
+			{
+				throw std::runtime_error("File changed since it was read: " + content.filename);
+			}
+			if (m_cache)
+			{
+				key = ParseCache::key(content.hash, m_options.recover);
+				entry = m_cache->find(key, source.data(), content.filename);
+			}
+
+			if (entry)
+			{
+				content.ok = entry->ok;
+				content.diagnostics = std::move(entry->diagnostics);
+				if (m_options.emit.empty() || !(content.ok || m_options.recover))
+				{
+					// No tree to write, no need to unpack it
+					this->emit(content, Ast());
+				}
+				else if (m_options.emit == "binary")
+				{
+					// Already in the output format
+					content.output = entry->tree.data();
+				}
+				else
+				{
+					entry->tree.unpack(cached);
+					this->emit(content, cached);
+				}
+			}
+			else
+			{
+				if (parser)
+				{
+					parser->reset(std::move(source));
+				}
+				else
+				{
+					parser.emplace(std::move(source));
+				}
+				parser->setRecovery(m_options.recover);
+				parser->setInterner(*m_interner);
+				content.ok = parser->tryParse();
+				content.diagnostics = parser->diagnostics();
+				this->emit(content, parser->ast().ast());
+				if (m_cache)
+				{
+					m_cache->store(key, parser->ast().ast(), parser->diagnostics(), content.ok, m_options.recover);
+				}
+			}
+		}
+		catch (std::exception const &e)
+		{
+			content.ok = false;
+			content.output.clear();
+			content.error = e.what();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			content.done = true;
+		}
+		m_done.notify_all();
+	}
+
+	void Driver::emit(Content &content, Ast const &ast) const
+	{
+		if (m_options.emit.empty())
+		{
+			content.output = content.ok ? "OK" : "";
+		}
+		else if (content.ok || m_options.recover)
+		{
+			StringSink sink(content.output);
+
+			// One tree per line, partial if errors were recovered from
+			this->emitter(sink)->write(ast);
+			if (m_options.emit != "binary")
+			{
+				sink.put('\n');
+			}
+		}
+	}
+
+	/// <summary>
+	/// Get the diagnostics of an input, one per line, under its own name
+	/// whichever input of the same content was parsed.
+	/// </summary>
+	std::string Driver::describe(Result const &result) const
+	{
+		Content const &content = m_contents[result.content];
+		std::string text;
+
+		if (!content.error.empty())
+		{
+			return content.error;
+		}
+		for (auto diagnostic : content.diagnostics)
+		{
+			diagnostic.file = result.filename;
+			if (!text.empty())
+			{
+				text += '\n';
+			}
+			text += diagnostic.str();
+		}
+		return text;
+	}
+
+	std::unique_ptr<Emitter> Driver::emitter(Sink &sink) const
+	{
+		if (m_options.emit == "json")
+		{
+			return std::make_unique<JsonEmitter>(sink, m_options.compact);
+		}
+		if (m_options.emit == "xml")
+		{
+			return std::make_unique<XmlEmitter>(sink);
+		}
+		if (m_options.emit == "code")
+		{
+			return std::make_unique<CodeEmitter>(sink);
+		}
+		if (m_options.emit == "binary")
+		{
+			return std::make_unique<BinaryEmitter>(sink);
+		}
+		throw std::invalid_argument("Unknown output format: " + m_options.emit);
+	}
+}
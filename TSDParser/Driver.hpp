@@ -0,0 +1,123 @@
+#ifndef NOPE_DTS_PARSER_DRIVER_HPP_
+# define NOPE_DTS_PARSER_DRIVER_HPP_
+
+# include <condition_variable>
+# include <cstddef>
+# include <cstdint>
+# include <memory>
+# include <mutex>
+# include <optional>
+# include <string>
+# include <vector>
+# include "Ast.hpp"
+# include "Diagnostic.hpp"
+# include "Emitter.hpp"
+# include "Interner.hpp"
+# include "ParseCache.hpp"
+# include "Sink.hpp"
+# include "Source.hpp"
+
+namespace nope::dts::parser
+{
+	struct Options
+	{
+		// "json", "xml", "code", "binary", or empty to only check the files
+		std::string emit;
+		bool compact = false;
+		std::string output = "-";
+		// 0 for one worker per hardware thread
+		std::size_t jobs = 0;
+		// Go on after syntax errors, reporting them all with the partial tree
+		bool recover = false;
+		// Directory of the parse cache, or empty to parse every file
+		std::string cache;
+		// Size in bytes the cache is evicted down to after the run, 0 for no limit
+		std::uintmax_t cacheSize = 512 * 1024 * 1024;
+	};
+
+	/// <summary>
+	/// Parses a batch of files concurrently.
+	/// A file failing to parse does not stop the others: every file gets a
+	/// result, and the results are written in the order of the inputs as soon
+	/// as all the previous ones are, whatever order they finish in. The files
+	/// are started largest first. With a cache directory, the files whose
+	/// content was parsed already are read from there instead.
+	///
+	/// The inputs are hashed before anything is parsed, and the inputs with
+	/// the same content share a single parse and its output; only their
+	/// diagnostics are told apart, by the name of each input.
+	/// </summary>
+	class Driver
+	{
+	public:
+		Driver(Options const &options);
+		Driver(Driver const &that) = delete;
+		Driver(Driver &&that) = delete;
+
+		~Driver() noexcept;
+
+		Driver &operator=(Driver const &that) = delete;
+		Driver &operator=(Driver &&that) = delete;
+
+		int run(std::vector<std::string> const &files);
+
+	private:
+		// An input as read up front, to tell identical ones apart
+		struct Input
+		{
+			// Only for the inputs that cannot be read again, files are unmapped once hashed
+			std::optional<Source> source;
+			std::size_t size = 0;
+			std::uint64_t hash = 0;
+			std::string error;
+		};
+
+		// A distinct content, parsed once for every input having it
+		struct Content
+		{
+			// The first input with this content, the one parsed
+			std::string filename;
+			// Kept from the hashing only if it cannot be read again, as the
+			// standard input; files are mapped again by the parse, so that a
+			// large batch is not mapped all at once
+			std::optional<Source> source;
+			std::size_t size = 0;
+			std::uint64_t hash = 0;
+			std::string output;
+			std::vector<Diagnostic> diagnostics;
+			// A failure other than syntax errors, reported as is
+			std::string error;
+			bool ok = false;
+			bool done = false;
+			// Inputs whose result is not written yet, the output is dropped after the last
+			std::size_t users = 0;
+		};
+
+		struct Result
+		{
+			std::string filename;
+			std::size_t content = 0;
+		};
+
+		void read(std::string const &filename, Input &input) const;
+		void group(std::vector<Input> &inputs);
+		bool equal(Content const &content, Input const &input, std::string const &filename) const;
+		std::vector<std::size_t> schedule() const;
+		void parse(Content &content);
+		void emit(Content &content, Ast const &ast) const;
+		std::string describe(Result const &result) const;
+		std::unique_ptr<Emitter> emitter(Sink &sink) const;
+
+		Options m_options;
+		std::unique_ptr<ParseCache> m_cache;
+		// Names of the current batch, freed with it
+		std::unique_ptr<Interner> m_interner;
+
+		std::vector<Content> m_contents;
+		std::vector<Result> m_results;
+		std::mutex m_mutex;
+		std::condition_variable m_done;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_DRIVER_HPP_
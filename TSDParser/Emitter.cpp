@@ -0,0 +1,412 @@
+#include "stdafx.h"
+#include <cstring>
+
+namespace nope::dts::parser
+{
+	namespace
+	{
+		constexpr char hex[] = "0123456789abcdef";
+
+		bool needsJsonEscape(char c)
+		{
+			return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+		}
+
+		bool needsXmlEscape(char c)
+		{
+			return c == '"' || c == '&' || c == '<' || c == '>' || c == '\''
+				|| c == '\n' || c == '\r' || c == '\t';
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Emitter"/> class.
+	/// </summary>
+	/// <param name="sink">Where the output is written.</param>
+	Emitter::Emitter(Sink &sink) :
+		m_sink(sink),
+		m_open()
+	{
+	}
+
+	Emitter::~Emitter() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Write the subtree rooted at <paramref name="id"/>.
+	/// </summary>
+	void Emitter::write(Ast const & ast, NodeId id)
+	{
+		NodeId const root = id;
+		bool first = true;
+
+		m_open.clear();
+		this->start(ast, root);
+		for (;;)
+		{
+			this->enter(ast, id, first);
+
+			NodeId child = isTerminal(ast.type(id)) ? Ast::none : ast.firstChild(id);
+
+			if (child != Ast::none)
+			{
+				m_open.push_back(id);
+				id = child;
+				first = true;
+				continue;
+			}
+			this->leave(ast, id);
+
+			// Close every node whose last child was just written
+			while (id != root && ast.nextSibling(id) == Ast::none)
+			{
+				id = m_open.back();
+				m_open.pop_back();
+				this->leave(ast, id);
+			}
+			if (id == root)
+			{
+				this->finish(ast, root);
+				return;
+			}
+			id = ast.nextSibling(id);
+			first = false;
+		}
+	}
+
+	/// <summary>
+	/// Write the whole tree, nothing if it is empty.
+	/// </summary>
+	void Emitter::write(Ast const & ast)
+	{
+		if (ast.root() != Ast::none)
+		{
+			this->write(ast, ast.root());
+		}
+	}
+
+	void Emitter::start(Ast const &, NodeId)
+	{
+	}
+
+	void Emitter::finish(Ast const &, NodeId)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="JsonEmitter"/> class.
+	/// </summary>
+	/// <param name="compact">Whether to drop the spaces after the separators.</param>
+	JsonEmitter::JsonEmitter(Sink &sink, bool compact) :
+		Emitter(sink),
+		m_compact(compact)
+	{
+	}
+
+	JsonEmitter::~JsonEmitter() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Write a quoted and escaped JSON string.
+	/// Runs of characters needing no escape are copied in one go; bytes above
+	/// 0x7F are copied as is, the input being UTF-8 already.
+	/// </summary>
+	void JsonEmitter::string(std::string_view value)
+	{
+		std::size_t begin = 0;
+
+		m_sink.put('"');
+		for (std::size_t i = 0; i < value.size(); ++i)
+		{
+			char c = value[i];
+
+			if (!needsJsonEscape(c))
+			{
+				continue;
+			}
+			m_sink.write(value.substr(begin, i - begin));
+			begin = i + 1;
+
+			switch (c)
+			{
+			case '"':
+				m_sink.write("\\\"");
+				break;
+			case '\\':
+				m_sink.write("\\\\");
+				break;
+			case '\n':
+				m_sink.write("\\n");
+				break;
+			case '\r':
+				m_sink.write("\\r");
+				break;
+			case '\t':
+				m_sink.write("\\t");
+				break;
+			case '\b':
+				m_sink.write("\\b");
+				break;
+			case '\f':
+				m_sink.write("\\f");
+				break;
+			default:
+				m_sink.write("\\u00");
+				m_sink.put(hex[(c >> 4) & 0xF]);
+				m_sink.put(hex[c & 0xF]);
+				break;
+			}
+		}
+		m_sink.write(value.substr(begin));
+		m_sink.put('"');
+	}
+
+	void JsonEmitter::enter(Ast const & ast, NodeId id, bool first)
+	{
+		if (!first)
+		{
+			this->separator();
+		}
+		m_sink.write("{\"type\":\"");
+		m_sink.write(name(ast.type(id)));
+		m_sink.put('"');
+		this->separator();
+
+		if (isTerminal(ast.type(id)))
+		{
+			m_sink.write("\"value\":");
+			this->string(ast.value(id));
+			m_sink.put('}');
+		}
+		else
+		{
+			m_sink.write("\"child\":[");
+		}
+	}
+
+	void JsonEmitter::leave(Ast const & ast, NodeId id)
+	{
+		if (!isTerminal(ast.type(id)))
+		{
+			m_sink.write("]}");
+		}
+	}
+
+	void JsonEmitter::separator()
+	{
+		m_sink.put(',');
+		if (!m_compact)
+		{
+			m_sink.put(' ');
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="XmlEmitter"/> class.
+	/// </summary>
+	XmlEmitter::XmlEmitter(Sink &sink) :
+		Emitter(sink)
+	{
+	}
+
+	XmlEmitter::~XmlEmitter() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Write an attribute value, escaping the markup characters and the line breaks.
+	/// </summary>
+	void XmlEmitter::attribute(std::string_view value)
+	{
+		std::size_t begin = 0;
+
+		for (std::size_t i = 0; i < value.size(); ++i)
+		{
+			char c = value[i];
+
+			if (!needsXmlEscape(c))
+			{
+				continue;
+			}
+			m_sink.write(value.substr(begin, i - begin));
+			begin = i + 1;
+
+			switch (c)
+			{
+			case '"':
+				m_sink.write("&quot;");
+				break;
+			case '&':
+				m_sink.write("&amp;");
+				break;
+			case '<':
+				m_sink.write("&lt;");
+				break;
+			case '>':
+				m_sink.write("&gt;");
+				break;
+			// Would be normalized to spaces by XML parsers otherwise
+			case '\n':
+				m_sink.write("&#10;");
+				break;
+			case '\r':
+				m_sink.write("&#13;");
+				break;
+			case '\t':
+				m_sink.write("&#9;");
+				break;
+			default:
+				m_sink.write("&apos;");
+				break;
+			}
+		}
+		m_sink.write(value.substr(begin));
+	}
+
+	void XmlEmitter::enter(Ast const & ast, NodeId id, bool)
+	{
+		m_sink.put('<');
+		m_sink.write(name(ast.type(id)));
+
+		if (isTerminal(ast.type(id)))
+		{
+			m_sink.write(" value=\"");
+			this->attribute(ast.value(id));
+			m_sink.write("\"/>");
+		}
+		else
+		{
+			m_sink.put('>');
+		}
+	}
+
+	void XmlEmitter::leave(Ast const & ast, NodeId id)
+	{
+		if (!isTerminal(ast.type(id)))
+		{
+			m_sink.write("</");
+			m_sink.write(name(ast.type(id)));
+			m_sink.put('>');
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="CodeEmitter"/> class.
+	/// </summary>
+	CodeEmitter::CodeEmitter(Sink &sink) :
+		Emitter(sink)
+	{
+	}
+
+	CodeEmitter::~CodeEmitter() noexcept
+	{
+	}
+
+	void CodeEmitter::enter(Ast const & ast, NodeId id, bool first)
+	{
+		if (!first)
+		{
+			m_sink.put(' ');
+		}
+		if (isTerminal(ast.type(id)))
+		{
+			m_sink.write(ast.value(id));
+		}
+	}
+
+	void CodeEmitter::leave(Ast const &, NodeId)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="BinaryEmitter"/> class.
+	/// The arrays are kept between writes.
+	/// </summary>
+	BinaryEmitter::BinaryEmitter(Sink &sink) :
+		Emitter(sink),
+		m_offset(),
+		m_length(),
+		m_next(),
+		m_end(),
+		m_type(),
+		m_path(),
+		m_previous(Ast::none)
+	{
+	}
+
+	BinaryEmitter::~BinaryEmitter() noexcept
+	{
+	}
+
+	void BinaryEmitter::start(Ast const &, NodeId)
+	{
+		m_offset.clear();
+		m_length.clear();
+		m_next.clear();
+		m_end.clear();
+		m_type.clear();
+		m_path.clear();
+		m_previous = Ast::none;
+	}
+
+	void BinaryEmitter::finish(Ast const & ast, NodeId)
+	{
+		static char const padding[8] = {};
+		std::size_t const count = m_type.size();
+		std::size_t const data = sizeof(MappedAst::Header) + count * (4 * sizeof(std::uint32_t) + 1) + ast.source().size();
+		hash::Stream checksum;
+		MappedAst::Header header{};
+
+		auto put = [this, &checksum](void const *data, std::size_t size)
+		{
+			std::string_view bytes(static_cast<char const *>(data), size);
+
+			checksum.update(bytes);
+			m_sink.write(bytes);
+		};
+
+		std::memcpy(header.magic, MappedAst::magic, sizeof(header.magic));
+		header.version = MappedAst::version;
+		header.byteOrder = MappedAst::byteOrder;
+		header.count = static_cast<std::uint32_t>(count);
+		header.sourceSize = static_cast<std::uint32_t>(ast.source().size());
+
+		put(&header, sizeof(header));
+		put(m_offset.data(), count * sizeof(std::uint32_t));
+		put(m_length.data(), count * sizeof(std::uint32_t));
+		put(m_next.data(), count * sizeof(std::uint32_t));
+		put(m_end.data(), count * sizeof(std::uint32_t));
+		put(m_type.data(), count);
+		put(ast.source().data(), ast.source().size());
+		put(padding, (8 - data % 8) % 8);
+
+		std::uint64_t const digest = checksum.digest();
+
+		m_sink.write(std::string_view(reinterpret_cast<char const *>(&digest), sizeof(digest)));
+	}
+
+	void BinaryEmitter::enter(Ast const & ast, NodeId id, bool first)
+	{
+		std::uint32_t const index = static_cast<std::uint32_t>(m_type.size());
+
+		if (!first)
+		{
+			m_next[m_previous] = index;
+		}
+		m_offset.push_back(ast.offset(id));
+		m_length.push_back(ast.length(id));
+		m_next.push_back(Ast::none);
+		m_end.push_back(0);
+		m_type.push_back(static_cast<std::uint8_t>(ast.type(id)));
+		m_path.push_back(index);
+	}
+
+	void BinaryEmitter::leave(Ast const &, NodeId)
+	{
+		m_previous = m_path.back();
+		m_path.pop_back();
+		m_end[m_previous] = static_cast<std::uint32_t>(m_type.size());
+	}
+}
@@ -0,0 +1,137 @@
+#ifndef NOPE_DTS_PARSER_EMITTER_HPP_
+# define NOPE_DTS_PARSER_EMITTER_HPP_
+
+# include <cstdint>
+# include <string_view>
+# include <vector>
+# include "Ast.hpp"
+# include "Sink.hpp"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Walks a syntax tree in document order and lets the derived emitter
+	/// write each node into a <see cref="Sink"/>.
+	/// The walk keeps its own stack of open nodes instead of recursing, so
+	/// deep trees neither overflow the call stack nor allocate per node, and
+	/// the stack is kept between writes.
+	/// </summary>
+	class Emitter
+	{
+	public:
+		Emitter(Sink &sink);
+		Emitter(Emitter const &that) = delete;
+		Emitter(Emitter &&that) = delete;
+
+		virtual ~Emitter() noexcept;
+
+		Emitter &operator=(Emitter const &that) = delete;
+		Emitter &operator=(Emitter &&that) = delete;
+
+		void write(Ast const &ast, NodeId id);
+		void write(Ast const &ast);
+
+	protected:
+		// Called before and after the whole subtree, do nothing by default
+		virtual void start(Ast const &ast, NodeId id);
+		virtual void finish(Ast const &ast, NodeId id);
+		// Called before the children of a node, first telling whether it is its parent's first child
+		virtual void enter(Ast const &ast, NodeId id, bool first) = 0;
+		// Called after the children of a node
+		virtual void leave(Ast const &ast, NodeId id) = 0;
+
+		Sink &m_sink;
+
+	private:
+		std::vector<NodeId> m_open;
+	};
+
+	/// <summary>
+	/// Writes terminals as {"type":..., "value":...} and other nodes as
+	/// {"type":..., "child":[...]}. The compact mode drops the spaces after
+	/// the separators.
+	/// </summary>
+	class JsonEmitter : public Emitter
+	{
+	public:
+		JsonEmitter(Sink &sink, bool compact = false);
+
+		~JsonEmitter() noexcept override;
+
+		void string(std::string_view value);
+
+	protected:
+		void enter(Ast const &ast, NodeId id, bool first) override;
+		void leave(Ast const &ast, NodeId id) override;
+
+	private:
+		void separator();
+
+		bool m_compact;
+	};
+
+	/// <summary>
+	/// Writes terminals as &lt;TYPE value="..."/&gt; and other nodes as
+	/// elements named after their type.
+	/// </summary>
+	class XmlEmitter : public Emitter
+	{
+	public:
+		XmlEmitter(Sink &sink);
+
+		~XmlEmitter() noexcept override;
+
+		void attribute(std::string_view value);
+
+	protected:
+		void enter(Ast const &ast, NodeId id, bool first) override;
+		void leave(Ast const &ast, NodeId id) override;
+	};
+
+	/// <summary>
+	/// Writes the binary format read by <see cref="MappedAst"/>.
+	/// The nodes are gathered in document order during the walk, then the
+	/// file is written in one go at the end of it.
+	/// </summary>
+	class BinaryEmitter : public Emitter
+	{
+	public:
+		BinaryEmitter(Sink &sink);
+
+		~BinaryEmitter() noexcept override;
+
+	protected:
+		void start(Ast const &ast, NodeId id) override;
+		void finish(Ast const &ast, NodeId id) override;
+		void enter(Ast const &ast, NodeId id, bool first) override;
+		void leave(Ast const &ast, NodeId id) override;
+
+	private:
+		std::vector<std::uint32_t> m_offset;
+		std::vector<std::uint32_t> m_length;
+		std::vector<std::uint32_t> m_next;
+		std::vector<std::uint32_t> m_end;
+		std::vector<std::uint8_t> m_type;
+		// Indexes of the nodes entered and not left yet
+		std::vector<std::uint32_t> m_path;
+		// Index of the node left last, the previous sibling of the next one entered
+		std::uint32_t m_previous;
+	};
+
+	/// <summary>
+	/// Regenerates the code from the terminals, separated by a single space.
+	/// </summary>
+	class CodeEmitter : public Emitter
+	{
+	public:
+		CodeEmitter(Sink &sink);
+
+		~CodeEmitter() noexcept override;
+
+	protected:
+		void enter(Ast const &ast, NodeId id, bool first) override;
+		void leave(Ast const &ast, NodeId id) override;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_EMITTER_HPP_
@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cstring>
+
+namespace nope::dts::parser::hash
+{
+	namespace
+	{
+		constexpr std::uint64_t c1 = 0x87c37b91114253d5ull;
+		constexpr std::uint64_t c2 = 0x4cf5ad432745937full;
+
+		inline std::uint64_t rotl(std::uint64_t x, int r)
+		{
+			return (x << r) | (x >> (64 - r));
+		}
+
+		inline std::uint64_t mix(std::uint64_t h, std::uint64_t k)
+		{
+			k *= c1;
+			k = rotl(k, 31);
+			k *= c2;
+			h ^= k;
+			return rotl(h, 27) * 5 + 0x52dce729;
+		}
+
+		inline std::uint64_t word(char const *data)
+		{
+			std::uint64_t k;
+
+			std::memcpy(&k, data, sizeof(k));
+			return k;
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Stream"/> class.
+	/// </summary>
+	/// <param name="seed">Different seeds give unrelated hashes of the same data.</param>
+	Stream::Stream(std::uint64_t seed) :
+		m_state(seed ^ 0x9e3779b97f4a7c15ull),
+		m_length(0),
+		m_tail(),
+		m_used(0)
+	{
+	}
+
+	void Stream::update(std::string_view data)
+	{
+		char const *p = data.data();
+		std::size_t n = data.size();
+
+		m_length += n;
+		if (m_used != 0)
+		{
+			std::size_t take = std::min(n, sizeof(m_tail) - m_used);
+
+			std::memcpy(m_tail + m_used, p, take);
+			m_used += take;
+			p += take;
+			n -= take;
+			if (m_used < sizeof(m_tail))
+			{
+				return;
+			}
+			m_state = mix(m_state, word(m_tail));
+			m_used = 0;
+		}
+		for (; n >= 8; p += 8, n -= 8)
+		{
+			m_state = mix(m_state, word(p));
+		}
+		std::memcpy(m_tail, p, n);
+		m_used = n;
+	}
+
+	std::uint64_t Stream::digest() const
+	{
+		std::uint64_t h = m_state;
+
+		if (m_used != 0)
+		{
+			char last[8] = {};
+
+			std::memcpy(last, m_tail, m_used);
+			h = mix(h, word(last));
+		}
+
+		// Avalanche, from MurmurHash3
+		h ^= m_length;
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	std::uint64_t of(std::string_view data, std::uint64_t seed)
+	{
+		Stream stream(seed);
+
+		stream.update(data);
+		return stream.digest();
+	}
+}
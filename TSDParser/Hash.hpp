@@ -0,0 +1,37 @@
+#ifndef NOPE_DTS_PARSER_HASH_HPP_
+# define NOPE_DTS_PARSER_HASH_HPP_
+
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+
+/// <summary>
+/// Fast non-cryptographic 64-bit hash, used for checksums and to tell
+/// contents apart. Reads 8 bytes at a time, in the byte order of the host,
+/// so the values are only comparable between hosts of the same byte order.
+/// </summary>
+namespace nope::dts::parser::hash
+{
+	/// <summary>
+	/// Hash of data fed by pieces, equal to the hash of their concatenation.
+	/// </summary>
+	class Stream
+	{
+	public:
+		Stream(std::uint64_t seed = 0);
+
+		void update(std::string_view data);
+		std::uint64_t digest() const;
+
+	private:
+		std::uint64_t m_state;
+		std::uint64_t m_length;
+		// Bytes of the last incomplete word
+		char m_tail[8];
+		std::size_t m_used;
+	};
+
+	std::uint64_t of(std::string_view data, std::uint64_t seed = 0);
+}
+
+#endif // !NOPE_DTS_PARSER_HASH_HPP_
@@ -0,0 +1,232 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace nope::dts::parser::input
+{
+	namespace
+	{
+		bool hasExtension(fs::path const &path)
+		{
+			std::string name = path.filename().string();
+
+			return name.size() >= extension.size()
+				&& name.compare(name.size() - extension.size(), extension.size(), extension) == 0;
+		}
+
+		void directory(fs::path const &root, std::vector<std::string> &files)
+		{
+			std::vector<std::string> found;
+
+			for (auto const &entry : fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied))
+			{
+				if (entry.is_regular_file() && hasExtension(entry.path()))
+				{
+					found.push_back(entry.path().string());
+				}
+			}
+			// The iteration order depends on the filesystem
+			std::sort(found.begin(), found.end());
+			files.insert(files.end(), found.begin(), found.end());
+		}
+
+		void glob(std::string const &pattern, std::vector<std::string> &files)
+		{
+			std::string generic = fs::path(pattern).generic_string();
+			// Walk from the deepest directory without wildcard
+			std::size_t wildcard = generic.find_first_of("*?[");
+			std::size_t slash = generic.rfind('/', wildcard);
+			fs::path root = slash == std::string::npos ? fs::path(".") : fs::path(generic.substr(0, slash + 1));
+			std::string_view relative = slash == std::string::npos ? std::string_view(generic)
+				: std::string_view(generic).substr(slash + 1);
+			std::vector<std::string> found;
+
+			if (!fs::is_directory(root))
+			{
+				return;
+			}
+			for (auto const &entry : fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied))
+			{
+				if (entry.is_regular_file()
+					&& match(relative, entry.path().lexically_relative(root).generic_string()))
+				{
+					found.push_back(slash == std::string::npos
+						? entry.path().lexically_relative(root).string() : entry.path().string());
+				}
+			}
+			std::sort(found.begin(), found.end());
+			files.insert(files.end(), found.begin(), found.end());
+		}
+
+		bool inSet(std::string_view set, char c)
+		{
+			for (std::size_t i = 0; i < set.size(); ++i)
+			{
+				if (i + 2 < set.size() && set[i + 1] == '-')
+				{
+					if (c >= set[i] && c <= set[i + 2])
+					{
+						return true;
+					}
+					i += 2;
+				}
+				else if (c == set[i])
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		void expandArgument(std::string const &argument, std::vector<std::string> &files, std::size_t depth)
+		{
+			if (argument.size() > 1 && argument[0] == '@')
+			{
+				std::string const name = argument.substr(1);
+				std::ifstream list(name);
+				std::string line;
+
+				if (!list)
+				{
+					throw std::runtime_error("Failed to open file: " + name);
+				}
+				if (depth > 16)
+				{
+					throw std::runtime_error("Too many nested response files: " + name);
+				}
+				while (std::getline(list, line))
+				{
+					std::size_t begin = line.find_first_not_of(" \t\r");
+					std::size_t end = line.find_last_not_of(" \t\r");
+
+					// Blank lines and comments
+					if (begin == std::string::npos || line[begin] == '#')
+					{
+						continue;
+					}
+					expandArgument(line.substr(begin, end - begin + 1), files, depth + 1);
+				}
+			}
+			else if (isPattern(argument))
+			{
+				glob(argument, files);
+			}
+			else if (argument != "-" && fs::is_directory(argument))
+			{
+				directory(argument, files);
+			}
+			else
+			{
+				files.push_back(argument);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Get the files named by the command line arguments, in order.
+	/// Directories and patterns are expanded in lexicographic order; paths
+	/// that do not exist are kept so that the parser reports them.
+	/// </summary>
+	std::vector<std::string> expand(std::vector<std::string> const &arguments)
+	{
+		std::vector<std::string> files;
+
+		for (auto const &argument : arguments)
+		{
+			expandArgument(argument, files, 0);
+		}
+		return files;
+	}
+
+	bool isPattern(std::string_view path)
+	{
+		return path.find_first_of("*?[") != std::string_view::npos;
+	}
+
+	/// <summary>
+	/// Match a '/' separated path against a glob pattern.
+	/// '?' matches one character, '*' any run of characters but '/', "**/"
+	/// any number of directories, and [abc] or [a-z] one character of a set.
+	/// </summary>
+	bool match(std::string_view pattern, std::string_view path)
+	{
+		// Backtracking points of the last '*' and "**/"
+		std::size_t p = 0;
+		std::size_t s = 0;
+		std::size_t starP = std::string_view::npos;
+		std::size_t starS = 0;
+		std::size_t globP = std::string_view::npos;
+		std::size_t globS = 0;
+
+		while (s < path.size())
+		{
+			if (pattern.compare(p, std::string_view::npos, "**") == 0)
+			{
+				return true;
+			}
+			if (pattern.compare(p, 3, "**/") == 0)
+			{
+				globP = p + 3;
+				globS = s;
+				starP = std::string_view::npos;
+				p += 3;
+				continue;
+			}
+			if (p < pattern.size() && pattern[p] == '*')
+			{
+				starP = ++p;
+				starS = s;
+				continue;
+			}
+
+			std::size_t close = p < pattern.size() && pattern[p] == '['
+				? pattern.find(']', p + 2) : std::string_view::npos;
+
+			if (close != std::string_view::npos)
+			{
+				if (path[s] != '/' && inSet(pattern.substr(p + 1, close - p - 1), path[s]))
+				{
+					p = close + 1;
+					++s;
+					continue;
+				}
+			}
+			else if (p < pattern.size()
+				&& (pattern[p] == path[s] || (pattern[p] == '?' && path[s] != '/')))
+			{
+				++p;
+				++s;
+				continue;
+			}
+			// Let the last '*' eat one more character, within the current directory
+			if (starP != std::string_view::npos && path[starS] != '/')
+			{
+				p = starP;
+				s = ++starS;
+				continue;
+			}
+			// Let the last "**/" eat one more directory
+			if (globP != std::string_view::npos)
+			{
+				std::size_t next = path.find('/', globS);
+
+				if (next != std::string_view::npos)
+				{
+					p = globP;
+					s = globS = next + 1;
+					starP = std::string_view::npos;
+					continue;
+				}
+			}
+			return false;
+		}
+		while (p < pattern.size() && pattern[p] == '*')
+		{
+			++p;
+		}
+		return p == pattern.size();
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef NOPE_DTS_PARSER_INPUT_HPP_
+# define NOPE_DTS_PARSER_INPUT_HPP_
+
+# include <string>
+# include <string_view>
+# include <vector>
+
+/// <summary>
+/// Expansion of the command line inputs into the list of files to parse.
+/// An argument can be a file, a directory (every *.d.ts below it), a glob
+/// pattern, or @list naming a response file with one argument per line.
+/// </summary>
+namespace nope::dts::parser::input
+{
+	constexpr std::string_view extension = ".d.ts";
+
+	std::vector<std::string> expand(std::vector<std::string> const &arguments);
+
+	bool isPattern(std::string_view path);
+	bool match(std::string_view pattern, std::string_view path);
+}
+
+#endif // !NOPE_DTS_PARSER_INPUT_HPP_
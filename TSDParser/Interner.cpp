@@ -0,0 +1,181 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace nope::dts::parser
+{
+	namespace
+	{
+		// Interners created so far, to number them
+		std::atomic<std::uint64_t> g_instances{ 0 };
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Interner::Cache"/> class.
+	/// </summary>
+	Interner::Cache::Cache() :
+		m_slots(size),
+		m_owner(0)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Interner"/> class, holding
+	/// the keywords and "global".
+	/// </summary>
+	Interner::Interner() :
+		m_shards(),
+		m_names(),
+		m_next(none + 1),
+		m_id(++g_instances)
+	{
+		for (auto &chunk : m_names)
+		{
+			chunk.store(nullptr, std::memory_order_relaxed);
+		}
+		for (auto const &k : keyword::list)
+		{
+			this->intern(k.name);
+		}
+		this->intern("global");
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="Interner"/> class.
+	/// </summary>
+	Interner::~Interner() noexcept
+	{
+		for (auto &chunk : m_names)
+		{
+			delete[] chunk.load(std::memory_order_relaxed);
+		}
+	}
+
+	/// <summary>
+	/// Get the interner shared by default by every tokenizer of the process,
+	/// so that symbols can be compared across files. It is never emptied.
+	/// </summary>
+	Interner &Interner::shared()
+	{
+		static Interner interner;
+
+		return interner;
+	}
+
+	/// <summary>
+	/// Get the symbol of a name, adding the name to the pool if needed.
+	/// </summary>
+	Symbol Interner::intern(std::string_view name)
+	{
+		return this->insert(name, hash(name));
+	}
+
+	/// <summary>
+	/// Get the symbol of a name through a cache of the recently interned
+	/// ones, taking a lock only when the cache misses. A cache last used with
+	/// another interner is emptied first, its names may be gone.
+	/// </summary>
+	Symbol Interner::intern(std::string_view name, Cache &cache)
+	{
+		if (cache.m_owner != m_id)
+		{
+			std::fill(cache.m_slots.begin(), cache.m_slots.end(), Cache::Slot());
+			cache.m_owner = m_id;
+		}
+
+		std::uint64_t h = hash(name);
+		Cache::Slot &slot = cache.m_slots[h & (Cache::size - 1)];
+
+		if (slot.symbol == none || slot.name != name)
+		{
+			slot.symbol = this->insert(name, h);
+			slot.name = this->name(slot.symbol);
+		}
+		return slot.symbol;
+	}
+
+	/// <summary>
+	/// Get the name of a symbol returned by this interner.
+	/// </summary>
+	/// <returns>The name, valid as long as the interner.</returns>
+	std::string_view Interner::name(Symbol symbol) const
+	{
+		return m_names[symbol / chunkSize].load(std::memory_order_acquire)[symbol % chunkSize];
+	}
+
+	/// <summary>
+	/// Get the number of symbols given, none included.
+	/// </summary>
+	std::size_t Interner::size() const
+	{
+		return m_next.load(std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// FNV-1a, good enough on identifiers and cheap on short ones.
+	/// </summary>
+	std::uint64_t Interner::hash(std::string_view name)
+	{
+		std::uint64_t h = 14695981039346656037ull;
+
+		for (char c : name)
+		{
+			h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		}
+		return h;
+	}
+
+	Symbol Interner::insert(std::string_view name, std::uint64_t hash)
+	{
+		// The low bits pick the cache slot, use others for the shard
+		Shard &shard = m_shards[(hash >> 32) & (shardCount - 1)];
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		auto found = shard.symbols.find(name);
+
+		if (found != shard.symbols.end())
+		{
+			return found->second;
+		}
+
+		Symbol symbol = m_next.fetch_add(1, std::memory_order_relaxed);
+
+		if (symbol / chunkSize >= chunkCount)
+		{
+			throw std::length_error("Too many distinct identifiers");
+		}
+
+		// Copy the name into the shard's storage, a name longer than a block getting its own
+		if (shard.blocks.empty() || shard.used + name.size() > blockSize)
+		{
+			shard.blocks.emplace_back(new char[std::max(name.size(), blockSize)]);
+			shard.used = 0;
+		}
+
+		char *copy = shard.blocks.back().get() + shard.used;
+
+		std::memcpy(copy, name.data(), name.size());
+		shard.used += name.size();
+
+		// Publish the name before the symbol can be seen through the map
+		auto &slot = m_names[symbol / chunkSize];
+		std::string_view *chunk = slot.load(std::memory_order_acquire);
+
+		if (chunk == nullptr)
+		{
+			std::string_view *fresh = new std::string_view[chunkSize];
+
+			if (slot.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel))
+			{
+				chunk = fresh;
+			}
+			else
+			{
+				delete[] fresh;
+			}
+		}
+		chunk[symbol % chunkSize] = std::string_view(copy, name.size());
+		shard.symbols.emplace(std::string_view(copy, name.size()), symbol);
+		return symbol;
+	}
+}
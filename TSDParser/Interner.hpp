@@ -0,0 +1,111 @@
+#ifndef NOPE_DTS_PARSER_INTERNER_HPP_
+# define NOPE_DTS_PARSER_INTERNER_HPP_
+
+# include <array>
+# include <atomic>
+# include <cstddef>
+# include <cstdint>
+# include <memory>
+# include <mutex>
+# include <string_view>
+# include <unordered_map>
+# include <vector>
+# include "Token.hpp"
+# include "Keyword.hpp"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Thread-safe pool mapping every distinct identifier to a dense symbol,
+	/// so that names are compared, hashed and used as keys as integers.
+	/// The pool is split in shards locked independently; the names are never
+	/// freed nor moved, and looking one up by symbol takes no lock. Every
+	/// interner starts with the keywords, in the order of keyword::list, and
+	/// "global", so that their symbols are constants.
+	/// Names are only freed with their interner, so the shared one grows with
+	/// every name the process reads: a long-lived process gives each batch an
+	/// interner of its own, see <see cref="Tokenizer::setInterner"/>.
+	/// </summary>
+	class Interner
+	{
+	public:
+		static constexpr Symbol none = 0;
+		static constexpr Symbol global = static_cast<Symbol>(keyword::count + 1);
+
+		/// <summary>
+		/// Recently interned names, in front of the shared pool.
+		/// Owned by a single thread, which then rarely takes a lock.
+		/// </summary>
+		class Cache
+		{
+		public:
+			Cache();
+
+		private:
+			friend class Interner;
+
+			struct Slot
+			{
+				std::string_view name;
+				Symbol symbol = none;
+			};
+
+			// Must be a power of two, the slot index is masked
+			static constexpr std::size_t size = 1024;
+
+			std::vector<Slot> m_slots;
+			// Id of the interner the slots come from, the cache is emptied when it changes
+			std::uint64_t m_owner;
+		};
+
+		Interner();
+		Interner(Interner const &that) = delete;
+		Interner(Interner &&that) = delete;
+
+		~Interner() noexcept;
+
+		Interner &operator=(Interner const &that) = delete;
+		Interner &operator=(Interner &&that) = delete;
+
+		static Interner &shared();
+
+		static constexpr Symbol keyword(std::size_t index)
+		{
+			return static_cast<Symbol>(index + 1);
+		}
+
+		Symbol intern(std::string_view name);
+		Symbol intern(std::string_view name, Cache &cache);
+		std::string_view name(Symbol symbol) const;
+		std::size_t size() const;
+
+	private:
+		// Must be a power of two, the shard index is masked
+		static constexpr std::size_t shardCount = 16;
+		static constexpr std::size_t chunkSize = 4096;
+		static constexpr std::size_t chunkCount = 4096;
+		static constexpr std::size_t blockSize = 64 * 1024;
+
+		struct Shard
+		{
+			std::mutex mutex;
+			std::unordered_map<std::string_view, Symbol> symbols;
+			// Storage of the names, by blocks that never move
+			std::vector<std::unique_ptr<char[]>> blocks;
+			std::size_t used = 0;
+		};
+
+		static std::uint64_t hash(std::string_view name);
+
+		Symbol insert(std::string_view name, std::uint64_t hash);
+
+		std::array<Shard, shardCount> m_shards;
+		// Names by symbol, by chunks allocated on first use
+		std::array<std::atomic<std::string_view *>, chunkCount> m_names;
+		std::atomic<Symbol> m_next;
+		// Unique to the instance, unlike its address
+		std::uint64_t m_id;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_INTERNER_HPP_
@@ -0,0 +1,113 @@
+#ifndef NOPE_DTS_PARSER_KEYWORD_HPP_
+# define NOPE_DTS_PARSER_KEYWORD_HPP_
+
+# include <array>
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+# include "Token.hpp"
+
+/// <summary>
+/// Keyword classification through a perfect hash computed at compile time.
+/// The hash only reads the length and the first and last characters of an
+/// identifier, and the table is checked for collisions by a static_assert,
+/// so finding an identifier costs one hash and one comparison.
+/// </summary>
+namespace nope::dts::parser::keyword
+{
+	struct Entry
+	{
+		std::string_view name;
+		TokenType type;
+	};
+
+	constexpr Entry list[] = {
+		{ "class", TokenType::KW_CLASS },
+		{ "interface", TokenType::KW_INTERFACE },
+		{ "constructor", TokenType::KW_CONSTRUCTOR },
+		{ "const", TokenType::KW_CONST },
+		{ "enum", TokenType::KW_ENUM },
+		{ "export", TokenType::KW_EXPORT },
+		{ "extends", TokenType::KW_EXTENDS },
+		{ "function", TokenType::KW_FUNCTION },
+		{ "import", TokenType::KW_IMPORT },
+		{ "in", TokenType::KW_IN },
+		{ "typeof", TokenType::KW_TYPEOF },
+		{ "type", TokenType::KW_TYPE },
+		{ "keyof", TokenType::KW_KEYOF },
+		{ "var", TokenType::KW_VAR },
+		{ "let", TokenType::KW_VAR },
+		{ "implements", TokenType::KW_IMPLEMENTS },
+		{ "private", TokenType::KW_VISIBILITY },
+		{ "protected", TokenType::KW_VISIBILITY },
+		{ "public", TokenType::KW_VISIBILITY },
+		{ "static", TokenType::KW_STATIC },
+		{ "readonly", TokenType::KW_READONLY },
+		{ "as", TokenType::KW_AS },
+		{ "is", TokenType::KW_IS },
+		{ "from", TokenType::KW_FROM },
+		{ "declare", TokenType::KW_DECLARE },
+		{ "module", TokenType::KW_MODULE },
+		{ "namespace", TokenType::KW_MODULE },
+		{ "require", TokenType::KW_REQUIRE }
+	};
+
+	constexpr std::size_t count = sizeof(list) / sizeof(list[0]);
+
+	// Must be a power of two; the factors in hash() were tuned for this size
+	constexpr std::size_t tableSize = 64;
+
+	/// <summary>
+	/// Hash a non-empty identifier into the keyword table.
+	/// </summary>
+	constexpr std::size_t hash(std::string_view id)
+	{
+		return (id.size() * 3
+			+ static_cast<unsigned char>(id.front()) * 7
+			+ static_cast<unsigned char>(id.back()) * 10) & (tableSize - 1);
+	}
+
+	constexpr std::array<std::uint8_t, tableSize> buildIndex()
+	{
+		std::array<std::uint8_t, tableSize> index{};
+
+		for (auto &i : index)
+		{
+			i = static_cast<std::uint8_t>(count);
+		}
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			index[hash(list[i].name)] = static_cast<std::uint8_t>(i);
+		}
+		return index;
+	}
+
+	// Position in list of the keyword of each slot, count for the empty ones
+	constexpr std::array<std::uint8_t, tableSize> index = buildIndex();
+
+	constexpr bool perfect()
+	{
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (index[hash(list[i].name)] != i)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	static_assert(perfect(), "Two keywords share a slot: retune keyword::hash or keyword::tableSize");
+
+	/// <summary>
+	/// Get the position of an identifier in list, or count if it is not a keyword.
+	/// </summary>
+	inline std::size_t find(std::string_view id)
+	{
+		std::size_t i = index[hash(id)];
+
+		return i < count && list[i].name == id ? i : count;
+	}
+}
+
+#endif // !NOPE_DTS_PARSER_KEYWORD_HPP_
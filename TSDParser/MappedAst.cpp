@@ -0,0 +1,247 @@
+#include "stdafx.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace nope::dts::parser
+{
+	static_assert(sizeof(MappedAst::Header) == 32, "The header is part of the file format");
+	static_assert(static_cast<int>(TokenType::Error) <= 0xFF, "Node types are stored on a byte");
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="MappedAst"/> class from a file.
+	/// </summary>
+	/// <param name="verify">Whether to check the checksum and that every index is in range.</param>
+	MappedAst::MappedAst(std::string_view filename, bool verify) :
+		MappedAst(Source(filename), verify)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="MappedAst"/> class from
+	/// a file already opened or held in memory.
+	/// </summary>
+	/// <param name="verify">Whether to check the checksum and that every index is in range.</param>
+	MappedAst::MappedAst(Source source, bool verify) :
+		m_file(std::move(source)),
+		m_count(0),
+		m_offset(nullptr),
+		m_length(nullptr),
+		m_next(nullptr),
+		m_end(nullptr),
+		m_type(nullptr),
+		m_source()
+	{
+		this->load(verify);
+	}
+
+	MappedAst::~MappedAst() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Get the size of a file holding <paramref name="count"/> nodes over a
+	/// source of <paramref name="sourceSize"/> bytes.
+	/// </summary>
+	std::size_t MappedAst::fileSize(std::size_t count, std::size_t sourceSize)
+	{
+		std::size_t const data = sizeof(Header) + count * (4 * sizeof(std::uint32_t) + 1) + sourceSize;
+
+		return (data + 7) / 8 * 8 + sizeof(std::uint64_t);
+	}
+
+	void MappedAst::load(bool verify)
+	{
+		// A borrowed buffer may not be aligned for the arrays
+		if (reinterpret_cast<std::uintptr_t>(m_file.data().data()) % alignof(std::uint64_t) != 0)
+		{
+			m_file = Source::own(std::string(m_file.data()), m_file.name());
+		}
+
+		std::string_view data = m_file.data();
+		Header header;
+
+		if (data.size() < sizeof(Header) + sizeof(std::uint64_t))
+		{
+			this->invalid("truncated");
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0)
+		{
+			this->invalid("not a syntax tree");
+		}
+		if (header.byteOrder != byteOrder)
+		{
+			this->invalid("written with another byte order");
+		}
+		if (header.version != version)
+		{
+			this->invalid("unsupported version");
+		}
+		if (data.size() != fileSize(header.count, header.sourceSize))
+		{
+			this->invalid("truncated");
+		}
+
+		auto const *words = reinterpret_cast<std::uint32_t const *>(data.data() + sizeof(Header));
+
+		m_count = header.count;
+		m_offset = words;
+		m_length = words + m_count;
+		m_next = words + 2 * std::size_t(m_count);
+		m_end = words + 3 * std::size_t(m_count);
+		m_type = reinterpret_cast<std::uint8_t const *>(words + 4 * std::size_t(m_count));
+		m_source = std::string_view(reinterpret_cast<char const *>(m_type + m_count), header.sourceSize);
+
+		if (!verify)
+		{
+			return;
+		}
+
+		std::uint64_t checksum;
+
+		std::memcpy(&checksum, data.data() + data.size() - sizeof(checksum), sizeof(checksum));
+		if (hash::of(data.substr(0, data.size() - sizeof(checksum))) != checksum)
+		{
+			this->invalid("checksum mismatch");
+		}
+		for (NodeId id = 0; id < m_count; ++id)
+		{
+			if (m_end[id] <= id || m_end[id] > m_count ||
+				(m_next[id] != Ast::none && m_next[id] != m_end[id]) ||
+				m_type[id] > static_cast<std::uint8_t>(TokenType::Error) ||
+				(m_offset[id] != Ast::npos && (m_offset[id] > m_source.size() ||
+					m_length[id] > m_source.size() - m_offset[id])))
+			{
+				this->invalid("corrupted node");
+			}
+		}
+	}
+
+	void MappedAst::invalid(char const *reason) const
+	{
+		throw std::runtime_error("Invalid syntax tree file: " + m_file.name() + ": " + reason);
+	}
+
+	/// <summary>
+	/// Get the whole file, as written by <see cref="BinaryEmitter"/>.
+	/// </summary>
+	std::string_view MappedAst::data() const
+	{
+		return m_file.data();
+	}
+
+	/// <summary>
+	/// Get the text the values refer to.
+	/// </summary>
+	std::string_view MappedAst::source() const
+	{
+		return m_source;
+	}
+
+	std::size_t MappedAst::size() const
+	{
+		return m_count;
+	}
+
+	NodeId MappedAst::root() const
+	{
+		return m_count != 0 ? 0 : Ast::none;
+	}
+
+	TokenType MappedAst::type(NodeId id) const
+	{
+		return static_cast<TokenType>(m_type[id]);
+	}
+
+	/// <summary>
+	/// Get the source text a node spans.
+	/// </summary>
+	std::string_view MappedAst::value(NodeId id) const
+	{
+		return m_offset[id] == Ast::npos ? std::string_view() : m_source.substr(m_offset[id], m_length[id]);
+	}
+
+	/// <summary>
+	/// Get the offset of the first terminal of a node, or npos if it has none.
+	/// </summary>
+	std::uint32_t MappedAst::offset(NodeId id) const
+	{
+		return m_offset[id];
+	}
+
+	std::uint32_t MappedAst::length(NodeId id) const
+	{
+		return m_length[id];
+	}
+
+	NodeId MappedAst::firstChild(NodeId id) const
+	{
+		return m_end[id] > id + 1 ? id + 1 : Ast::none;
+	}
+
+	NodeId MappedAst::nextSibling(NodeId id) const
+	{
+		return m_next[id];
+	}
+
+	/// <summary>
+	/// Get the index past the subtree of a node, to skip over it.
+	/// </summary>
+	NodeId MappedAst::end(NodeId id) const
+	{
+		return m_end[id];
+	}
+
+	std::uint32_t MappedAst::childCount(NodeId id) const
+	{
+		std::uint32_t count = 0;
+
+		for (NodeId c = this->firstChild(id); c != Ast::none; c = m_next[c])
+		{
+			++count;
+		}
+		return count;
+	}
+
+	NodeId MappedAst::child(NodeId id, std::size_t index) const
+	{
+		NodeId c = this->firstChild(id);
+
+		while (c != Ast::none && index-- > 0)
+		{
+			c = m_next[c];
+		}
+		return c;
+	}
+
+	/// <summary>
+	/// Rebuild the tree in <paramref name="ast"/>, for the code written
+	/// against it. The values still point into this tree's source, and the
+	/// symbols are not restored.
+	/// </summary>
+	void MappedAst::unpack(Ast &ast) const
+	{
+		// Indexes of the nodes whose subtree is not over yet
+		std::vector<NodeId> path;
+
+		ast.reset(m_source, m_count);
+		for (NodeId id = 0; id < m_count; ++id)
+		{
+			// Created in the same order, so with the same indexes
+			ast.create(Token(this->type(id), m_offset[id], m_length[id]));
+			while (!path.empty() && m_end[path.back()] <= id)
+			{
+				path.pop_back();
+			}
+			if (path.empty())
+			{
+				ast.setRoot(id);
+			}
+			else
+			{
+				ast.append(path.back(), id);
+			}
+			path.push_back(id);
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#ifndef NOPE_DTS_PARSER_MAPPEDAST_HPP_
+# define NOPE_DTS_PARSER_MAPPEDAST_HPP_
+
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+# include "Ast.hpp"
+# include "Source.hpp"
+# include "Token.hpp"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Syntax tree read in place from the binary format written by
+	/// <see cref="BinaryEmitter"/>, with the accessors of <see cref="Ast"/>.
+	/// The file is memory-mapped and walked as is: loading it costs the
+	/// checks of the header, and the checksum unless told otherwise.
+	///
+	/// The format, in the byte order of the writer, the arrays of integers
+	/// aligned on their size:
+	///   Header
+	///   offset[count], length[count]    uint32, span in the source, offset npos if none
+	///   next[count]                     uint32, next sibling or Ast::none
+	///   end[count]                      uint32, index past the node's subtree
+	///   type[count]                     uint8, a TokenType
+	///   source[sourceSize]              the text the spans refer to
+	///   padding                         zeros up to a multiple of 8 bytes
+	///   checksum                        uint64, hash::of every byte before it
+	/// Nodes are numbered in document order from the root, 0, so the first
+	/// child of a node is the next one and its subtree a contiguous range.
+	/// Symbols are not stored, they are only meaningful within a process.
+	/// </summary>
+	class MappedAst
+	{
+	public:
+		struct Header
+		{
+			char magic[4];
+			std::uint16_t version;
+			std::uint16_t byteOrder;
+			std::uint32_t count;
+			std::uint32_t sourceSize;
+			std::uint32_t reserved[4];
+		};
+
+		static constexpr char magic[4] = { 'T', 'S', 'D', 'A' };
+		// To be bumped on any change of the layout
+		static constexpr std::uint16_t version = 1;
+		// Reads 0x0201 when written by a host of the other byte order
+		static constexpr std::uint16_t byteOrder = 0x0102;
+
+		MappedAst() = delete;
+		MappedAst(std::string_view filename, bool verify = true);
+		MappedAst(Source source, bool verify = true);
+		MappedAst(MappedAst const &that) = delete;
+		MappedAst(MappedAst &&that) noexcept = default;
+
+		~MappedAst() noexcept;
+
+		MappedAst &operator=(MappedAst const &that) = delete;
+		MappedAst &operator=(MappedAst &&that) noexcept = default;
+
+		static std::size_t fileSize(std::size_t count, std::size_t sourceSize);
+
+		std::string_view data() const;
+		std::string_view source() const;
+		std::size_t size() const;
+
+		NodeId root() const;
+
+		TokenType type(NodeId id) const;
+		std::string_view value(NodeId id) const;
+		std::uint32_t offset(NodeId id) const;
+		std::uint32_t length(NodeId id) const;
+
+		NodeId firstChild(NodeId id) const;
+		NodeId nextSibling(NodeId id) const;
+		NodeId end(NodeId id) const;
+		std::uint32_t childCount(NodeId id) const;
+		NodeId child(NodeId id, std::size_t index) const;
+
+		void unpack(Ast &ast) const;
+
+	private:
+		void load(bool verify);
+		[[noreturn]] void invalid(char const *reason) const;
+
+		Source m_file;
+		std::uint32_t m_count;
+		std::uint32_t const *m_offset;
+		std::uint32_t const *m_length;
+		std::uint32_t const *m_next;
+		std::uint32_t const *m_end;
+		std::uint8_t const *m_type;
+		std::string_view m_source;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_MAPPEDAST_HPP_
@@ -0,0 +1,320 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace nope::dts::parser
+{
+	static_assert(sizeof(ParseCache::Header) == 32, "The header is part of the file format");
+
+	namespace
+	{
+		constexpr char extension[] = ".tsdc";
+
+		// Size of a diagnostic in an entry, before its message
+		constexpr std::size_t diagnosticSize = 4 * sizeof(std::uint32_t);
+
+		std::size_t padded(std::size_t size)
+		{
+			return (size + 7) / 8 * 8;
+		}
+
+		// Distinguishes the temporary files of the processes and threads sharing the directory
+		std::string unique()
+		{
+			static std::uint64_t const process = (std::uint64_t(std::random_device()()) << 32) | std::random_device()();
+			static std::atomic<std::uint64_t> counter{ 0 };
+			char buffer[40];
+
+			std::snprintf(buffer, sizeof(buffer), "%016llx.%llu", static_cast<unsigned long long>(process),
+				static_cast<unsigned long long>(counter.fetch_add(1, std::memory_order_relaxed)));
+			return buffer;
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="ParseCache::Entry"/> class
+	/// over an entry file, the tree starting <paramref name="treeOffset"/> bytes in.
+	/// </summary>
+	ParseCache::Entry::Entry(Source file, std::size_t treeOffset) :
+		file(std::move(file)),
+		tree(Source::borrow(this->file.data().substr(treeOffset), this->file.name())),
+		diagnostics(),
+		ok(false)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="ParseCache"/> class,
+	/// creating the directory if needed.
+	/// </summary>
+	/// <param name="capacity">Size in bytes the entries are evicted down to, 0 for no limit.</param>
+	ParseCache::ParseCache(std::string const &directory, std::uintmax_t capacity) :
+		m_directory(directory),
+		m_capacity(capacity),
+		m_hits(0),
+		m_misses(0),
+		m_stored(0),
+		m_evicted(0)
+	{
+		std::error_code error;
+
+		std::filesystem::create_directories(m_directory, error);
+		if (!std::filesystem::is_directory(m_directory, error))
+		{
+			throw std::runtime_error("Failed to create cache directory: " + directory);
+		}
+	}
+
+	ParseCache::~ParseCache() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Get the key of a content from its hash::of, the key also depending on
+	/// the versions of the parser and of the formats, and on the mode of the parse.
+	/// </summary>
+	std::uint64_t ParseCache::key(std::uint64_t content, bool recover)
+	{
+		std::uint64_t const fields[2] = {
+			content,
+			(std::uint64_t(Parser::version) << 32) | (std::uint64_t(version) << 24) |
+				(std::uint64_t(MappedAst::version) << 8) | (recover ? 1 : 0)
+		};
+
+		return hash::of(std::string_view(reinterpret_cast<char const *>(fields), sizeof(fields)));
+	}
+
+	/// <summary>
+	/// Look a content up, counting a hit or a miss.
+	/// </summary>
+	/// <param name="filename">The name the diagnostics are reported with.</param>
+	/// <returns>The entry, or nullptr if there is none for this content.</returns>
+	std::unique_ptr<ParseCache::Entry> ParseCache::find(std::uint64_t key, std::string_view content,
+		std::string const &filename)
+	{
+		std::filesystem::path const path = this->path(key);
+		std::error_code error;
+		std::unique_ptr<Entry> entry;
+
+		if (std::filesystem::is_regular_file(path, error))
+		{
+			try
+			{
+				entry = this->load(path, key, content, filename);
+			}
+			catch (std::exception const &)
+			{
+				// Evicted meanwhile, or unreadable: as good as missing
+			}
+		}
+		if (!entry)
+		{
+			m_misses.fetch_add(1, std::memory_order_relaxed);
+			return nullptr;
+		}
+		// Recently used, the last to be evicted
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+		m_hits.fetch_add(1, std::memory_order_relaxed);
+		return entry;
+	}
+
+	std::unique_ptr<ParseCache::Entry> ParseCache::load(std::filesystem::path const &path, std::uint64_t key,
+		std::string_view content, std::string const &filename) const
+	{
+		Source file(path.string());
+		std::string_view data = file.data();
+		Header header;
+
+		if (data.size() < sizeof(Header))
+		{
+			return nullptr;
+		}
+		std::memcpy(&header, data.data(), sizeof(header));
+		if (std::memcmp(header.magic, magic, sizeof(magic)) != 0 || header.version != version ||
+			header.byteOrder != MappedAst::byteOrder || header.parser != Parser::version || header.key != key ||
+			header.diagnosticsSize % 8 != 0 || header.diagnosticsSize > data.size() - sizeof(Header))
+		{
+			return nullptr;
+		}
+
+		std::string_view diagnostics = data.substr(sizeof(Header), header.diagnosticsSize);
+		auto entry = std::make_unique<Entry>(std::move(file), sizeof(Header) + header.diagnosticsSize);
+
+		// Same hash, other content
+		if (entry->tree.source() != content)
+		{
+			return nullptr;
+		}
+
+		entry->ok = (header.flags & OK) != 0;
+		entry->diagnostics.reserve(header.diagnosticCount);
+		for (std::uint32_t i = 0; i < header.diagnosticCount; ++i)
+		{
+			std::uint32_t fields[4];
+			Diagnostic diagnostic;
+
+			if (diagnostics.size() < diagnosticSize)
+			{
+				return nullptr;
+			}
+			std::memcpy(fields, diagnostics.data(), diagnosticSize);
+			diagnostics.remove_prefix(diagnosticSize);
+			if (diagnostics.size() < fields[3])
+			{
+				return nullptr;
+			}
+			diagnostic.file = filename;
+			diagnostic.offset = fields[0];
+			diagnostic.line = fields[1];
+			diagnostic.column = fields[2];
+			diagnostic.message = diagnostics.substr(0, fields[3]);
+			diagnostics.remove_prefix(fields[3]);
+			entry->diagnostics.push_back(std::move(diagnostic));
+		}
+		return entry;
+	}
+
+	/// <summary>
+	/// Write the result of parsing a content. The entry replaces any other
+	/// one with the same key at once, and nothing is written on failure.
+	/// </summary>
+	void ParseCache::store(std::uint64_t key, Ast const &ast, std::vector<Diagnostic> const &diagnostics,
+		bool ok, bool recover)
+	{
+		static char const padding[8] = {};
+		std::filesystem::path const path = this->path(key);
+		std::filesystem::path const temporary = path.string() + '.' + unique() + ".tmp";
+		Header header{};
+		std::size_t size = 0;
+		std::error_code error;
+
+		for (auto const &diagnostic : diagnostics)
+		{
+			size += diagnosticSize + diagnostic.message.size();
+		}
+
+		std::memcpy(header.magic, magic, sizeof(header.magic));
+		header.version = version;
+		header.byteOrder = MappedAst::byteOrder;
+		header.parser = Parser::version;
+		header.flags = (ok ? std::uint32_t(OK) : 0) | (recover ? std::uint32_t(RECOVER) : 0);
+		header.key = key;
+		header.diagnosticsSize = static_cast<std::uint32_t>(padded(size));
+		header.diagnosticCount = static_cast<std::uint32_t>(diagnostics.size());
+
+		try
+		{
+			FdSink sink(temporary.string());
+
+			sink.write(std::string_view(reinterpret_cast<char const *>(&header), sizeof(header)));
+			for (auto const &diagnostic : diagnostics)
+			{
+				std::uint32_t const fields[4] = {
+					diagnostic.offset,
+					static_cast<std::uint32_t>(diagnostic.line),
+					static_cast<std::uint32_t>(diagnostic.column),
+					static_cast<std::uint32_t>(diagnostic.message.size())
+				};
+
+				sink.write(std::string_view(reinterpret_cast<char const *>(fields), diagnosticSize));
+				sink.write(diagnostic.message);
+			}
+			sink.write(std::string_view(padding, padded(size) - size));
+			BinaryEmitter(sink).write(ast);
+			// The destructor would swallow a failure
+			sink.flush();
+		}
+		catch (std::exception const &)
+		{
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+
+		std::filesystem::rename(temporary, path, error);
+		if (error)
+		{
+			// Most likely held open by another process, which wrote the same entry anyway
+			std::filesystem::remove(temporary, error);
+			return;
+		}
+		m_stored.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Remove the least recently used entries until the directory fits its
+	/// capacity. The temporary files of the writers are left alone.
+	/// </summary>
+	void ParseCache::evict()
+	{
+		struct File
+		{
+			std::filesystem::file_time_type time;
+			std::uintmax_t size;
+			std::filesystem::path path;
+		};
+
+		std::vector<File> files;
+		std::uintmax_t total = 0;
+		std::error_code error;
+
+		if (m_capacity == 0)
+		{
+			return;
+		}
+		for (std::filesystem::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error))
+		{
+			std::error_code fileError;
+			File file{ it->last_write_time(fileError), it->file_size(fileError), it->path() };
+
+			// Gone meanwhile, or not an entry
+			if (fileError || file.path.extension() != extension)
+			{
+				continue;
+			}
+			total += file.size;
+			files.push_back(std::move(file));
+		}
+		if (total <= m_capacity)
+		{
+			return;
+		}
+
+		std::sort(files.begin(), files.end(), [](File const &l, File const &r) { return l.time < r.time; });
+		for (auto const &file : files)
+		{
+			if (total <= m_capacity)
+			{
+				break;
+			}
+			// Another process may have evicted or still map it, leave it to it;
+			// its size only counts as freed if it was removed here
+			if (std::filesystem::remove(file.path, error))
+			{
+				m_evicted.fetch_add(1, std::memory_order_relaxed);
+				total -= file.size;
+			}
+		}
+	}
+
+	ParseCache::Stats ParseCache::stats() const
+	{
+		Stats stats;
+
+		stats.hits = m_hits.load(std::memory_order_relaxed);
+		stats.misses = m_misses.load(std::memory_order_relaxed);
+		stats.stored = m_stored.load(std::memory_order_relaxed);
+		stats.evicted = m_evicted.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	std::filesystem::path ParseCache::path(std::uint64_t key) const
+	{
+		char name[32];
+
+		std::snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(key), extension);
+		return m_directory / name;
+	}
+}
@@ -0,0 +1,113 @@
+#ifndef NOPE_DTS_PARSER_PARSECACHE_HPP_
+# define NOPE_DTS_PARSER_PARSECACHE_HPP_
+
+# include <atomic>
+# include <cstddef>
+# include <cstdint>
+# include <filesystem>
+# include <memory>
+# include <string>
+# include <string_view>
+# include <vector>
+# include "Ast.hpp"
+# include "Diagnostic.hpp"
+# include "MappedAst.hpp"
+# include "Source.hpp"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Directory of parse results keyed by the hash of the parsed content, so
+	/// that an unchanged file costs a hash and a memory mapping instead of a
+	/// parse. An entry holds the diagnostics and the tree in the format of
+	/// <see cref="MappedAst"/>, whose copy of the source is compared with the
+	/// content looked up, so a collision of the hashes is only a miss.
+	///
+	/// Entries are written to a temporary file renamed over the final one, so
+	/// several processes can share the directory: a reader sees a whole entry
+	/// or none. Every hit touches the entry, and evict() removes the least
+	/// recently used ones until the directory fits its capacity. Failing to
+	/// read or write an entry is never an error, the file is just parsed.
+	/// </summary>
+	class ParseCache
+	{
+	public:
+		struct Header
+		{
+			char magic[4];
+			std::uint16_t version;
+			std::uint16_t byteOrder;
+			std::uint32_t parser;
+			std::uint32_t flags;
+			std::uint64_t key;
+			// Size of the diagnostics, padded so that the tree is aligned
+			std::uint32_t diagnosticsSize;
+			std::uint32_t diagnosticCount;
+		};
+
+		enum Flags : std::uint32_t
+		{
+			OK = 1,
+			RECOVER = 2
+		};
+
+		static constexpr char magic[4] = { 'T', 'S', 'D', 'C' };
+		// To be bumped on any change of the layout of an entry
+		static constexpr std::uint16_t version = 1;
+
+		/// <summary>
+		/// A cached parse result, valid as long as the entry is alive.
+		/// </summary>
+		struct Entry
+		{
+			Entry(Source file, std::size_t treeOffset);
+
+			Source file;
+			MappedAst tree;
+			std::vector<Diagnostic> diagnostics;
+			bool ok = false;
+		};
+
+		struct Stats
+		{
+			std::size_t hits = 0;
+			std::size_t misses = 0;
+			std::size_t stored = 0;
+			std::size_t evicted = 0;
+		};
+
+		ParseCache() = delete;
+		ParseCache(std::string const &directory, std::uintmax_t capacity);
+		ParseCache(ParseCache const &that) = delete;
+		ParseCache(ParseCache &&that) = delete;
+
+		~ParseCache() noexcept;
+
+		ParseCache &operator=(ParseCache const &that) = delete;
+		ParseCache &operator=(ParseCache &&that) = delete;
+
+		static std::uint64_t key(std::uint64_t content, bool recover);
+
+		std::unique_ptr<Entry> find(std::uint64_t key, std::string_view content, std::string const &filename);
+		void store(std::uint64_t key, Ast const &ast, std::vector<Diagnostic> const &diagnostics, bool ok, bool recover);
+		void evict();
+
+		Stats stats() const;
+
+	private:
+		std::filesystem::path path(std::uint64_t key) const;
+		std::unique_ptr<Entry> load(std::filesystem::path const &path, std::uint64_t key,
+			std::string_view content, std::string const &filename) const;
+
+		std::filesystem::path m_directory;
+		// 0 for no limit
+		std::uintmax_t m_capacity;
+
+		std::atomic<std::size_t> m_hits;
+		std::atomic<std::size_t> m_misses;
+		std::atomic<std::size_t> m_stored;
+		std::atomic<std::size_t> m_evicted;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_PARSECACHE_HPP_
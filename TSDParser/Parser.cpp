@@ -1,42 +1,365 @@
 #include "stdafx.h"
+#include <stdexcept>
 
 namespace nope::dts::parser
 {
 	Parser::Parser(std::string_view filename) :
-		m_input(filename),
-		m_ast(TokenType::UNKNOWN)
+		Parser(Source(filename))
 	{
 	}
 
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Parser"/> class over text
+	/// already in memory, see <see cref="Source::borrow"/>.
+	/// </summary>
+	/// <param name="mode">Whether to keep the blanks and comments, see <see cref="trivia"/>.</param>
+	Parser::Parser(Source source, TriviaMode mode) :
+		m_input(std::move(source), mode),
+		m_ast(),
+		m_clean(false)
+	{
+		m_ast.reset(m_input.source(), m_input.source().size() / 4);
+	}
+
 	Parser::~Parser() noexcept
 	{
 	}
 
+	/// <summary>
+	/// Prepare the parser for another input, keeping the memory of the token
+	/// list, the indexes and the AST arena.
+	/// </summary>
+	void Parser::reset(Source source, TriviaMode mode)
+	{
+		m_input.reset(std::move(source), mode);
+		// About one node every four bytes of typings, the arena grows if needed
+		m_ast.reset(m_input.source(), m_input.source().size() / 4);
+		m_clean = false;
+	}
+
+	/// <summary>
+	/// Parse the input, throwing the first syntax error unless in recovery mode.
+	/// </summary>
 	void Parser::parse()
 	{
-		m_ast = this->parseFile();
+		if (!this->tryParse() && !m_input.recovery())
+		{
+			throw error::Syntax(m_input.diagnostics().front());
+		}
+	}
+
+	/// <summary>
+	/// Parse the input without throwing on syntax errors, see <see cref="diagnostics"/>.
+	/// Out of recovery mode the tree is unspecified after an error.
+	/// </summary>
+	/// <returns>true if the input has no syntax error.</returns>
+	bool Parser::tryParse()
+	{
+		m_ast.setRoot(this->parseFile().id());
+		m_clean = m_input.diagnostics().empty();
+		return m_clean;
+	}
+
+	/// <summary>
+	/// Apply a text edit to the input and update the tree.
+	/// Only the innermost file, namespace or class element containing the
+	/// edit is parsed again, and spliced in place of the old one; the whole
+	/// input is parsed again when there is no such element, when the new
+	/// element does not end where the old one did, when the last parse was
+	/// not clean, in TriviaMode::FULL, or in recovery mode so that the
+	/// diagnostics cover the whole input.
+	/// The replaced nodes stay in the arena until they outnumber the live
+	/// ones, then the arena is compacted: an edit costs the size of the
+	/// element, amortized, whatever the number of edits before.
+	/// </summary>
+	/// <param name="offset">Where the edit starts.</param>
+	/// <param name="removed">The number of bytes removed from offset.</param>
+	/// <param name="inserted">The text inserted at offset.</param>
+	/// <returns>true if the edit was parsed incrementally.</returns>
+	bool Parser::edit(std::uint32_t offset, std::uint32_t removed, std::string_view inserted)
+	{
+		std::string_view old = m_input.source();
+
+		if (offset > old.size() || removed > old.size() - offset)
+		{
+			throw std::out_of_range("Edit out of the input: " + m_input.name());
+		}
+
+		std::uint32_t const end = offset + removed;
+		std::int64_t const delta = static_cast<std::int64_t>(inserted.size()) - removed;
+		std::string text;
+
+		text.reserve(old.size() + inserted.size() - removed);
+		text.append(old.substr(0, offset));
+		text.append(inserted);
+		text.append(old.substr(end));
+
+		// Innermost element strictly containing the edit, with its parent and previous sibling
+		NodeId target = Ast::none;
+		NodeId parent = Ast::none;
+		NodeId previous = Ast::none;
+
+		// A tree cut short or patched by an error cannot be trusted around the edit
+		bool const incremental = m_clean && m_input.mode() == TriviaMode::FAST && !m_input.recovery();
+
+		for (NodeId id = m_ast.root(); id != Ast::none && incremental;)
+		{
+			NodeId found = Ast::none;
+			NodeId before = Ast::none;
+
+			for (NodeId c = m_ast.firstChild(id); c != Ast::none; before = c, c = m_ast.nextSibling(c))
+			{
+				if (m_ast.offset(c) != Ast::npos && m_ast.offset(c) < offset &&
+					end < m_ast.offset(c) + m_ast.length(c))
+				{
+					found = c;
+					break;
+				}
+			}
+			if (found != Ast::none && (m_ast.type(found) == TokenType::FileElement ||
+				m_ast.type(found) == TokenType::NamespaceElement ||
+				m_ast.type(found) == TokenType::ClassElement))
+			{
+				target = found;
+				parent = id;
+				previous = before;
+			}
+			id = found;
+		}
+
+		m_input.reset(Source::own(std::move(text), m_input.name()), m_input.mode());
+
+		if (target == Ast::none)
+		{
+			this->reparse();
+			return false;
+		}
+
+		std::uint32_t const begin = m_ast.offset(target);
+		std::int64_t const last = m_ast.offset(target) + m_ast.length(target) + delta;
+		TokenType const type = m_ast.type(target);
+		Node node;
+
+		m_ast.rebase(m_input.source(), end, delta);
+		m_input.seek(begin);
+
+		if (type == TokenType::FileElement)
+		{
+			node = this->parseFileElement();
+		}
+		else if (type == TokenType::NamespaceElement)
+		{
+			node = this->parseNamespaceElement();
+		}
+		else
+		{
+			node = this->parseClassElement();
+		}
+
+		// Report the error as a full parse would
+		if (m_input.failed())
+		{
+			this->reparse();
+			return false;
+		}
+
+		// The element must cover the same tokens, otherwise the following ones changed too
+		if (m_ast.offset(node.id()) != begin || m_ast.offset(node.id()) + m_ast.length(node.id()) != last ||
+			m_input.consumed() != static_cast<std::size_t>(last))
+		{
+			this->reparse();
+			return false;
+		}
+
+		m_ast.replace(parent, previous, target, node.id());
+		if (m_ast.sparse())
+		{
+			m_ast.compact();
+		}
+		return true;
+	}
+
+	/// <summary>
+	/// Parse the whole current input again.
+	/// </summary>
+	void Parser::reparse()
+	{
+		m_input.seek(0);
+		m_ast.reset(m_input.source(), m_input.source().size() / 4);
+		this->parse();
 	}
 
-	Token const & Parser::ast() const
+	/// <summary>
+	/// Enable or disable the recovery mode, kept across resets.
+	/// A syntax error then no longer stops the parse: it is recorded in
+	/// <see cref="diagnostics"/>, the file, namespace or class element it is
+	/// in is replaced by an Error node holding its tokens up to the next ';',
+	/// newline or '}', and the parse goes on with the next element. The tree
+	/// is complete but for the Error nodes.
+	/// </summary>
+	void Parser::setRecovery(bool enabled)
 	{
-		return m_ast;
+		m_input.setRecovery(enabled);
 	}
 
-	Token Parser::parseFile()
+	/// <summary>
+	/// Intern the names into <paramref name="interner"/>, kept across resets,
+	/// see <see cref="Tokenizer::setInterner"/>.
+	/// </summary>
+	void Parser::setInterner(Interner &interner)
 	{
-		Token file(TokenType::File);
+		m_input.setInterner(interner);
+	}
+
+	/// <summary>
+	/// Get the errors found by the last parse, sorted by offset: at most one
+	/// unless in recovery mode.
+	/// </summary>
+	std::vector<Diagnostic> const & Parser::diagnostics() const
+	{
+		return m_input.diagnostics();
+	}
+
+	/// <summary>
+	/// Parse a file, namespace or class element into <paramref name="container"/>,
+	/// or in recovery mode an Error node in its place if it is invalid.
+	/// </summary>
+	void Parser::parseElement(Node & container, Node (Parser::*parse)())
+	{
+		// Failed before it started: the error belongs to an enclosing element
+		if (m_input.failed())
+		{
+			return;
+		}
+
+		NodeId const mark = static_cast<NodeId>(m_ast.size());
+		Node node = (this->*parse)();
+
+		if (!m_input.failed() || !m_input.recovery())
+		{
+			container << node;
+			return;
+		}
+
+		m_input.resume();
+
+		Node error = this->parseError(mark);
+
+		// Nothing left to skip: the enclosing element is the one unfinished
+		if (error.size() == 0)
+		{
+			m_input.error("Unexpected end of file", m_input.peek(0, false));
+			return;
+		}
+		container << error;
+	}
+
+	/// <summary>
+	/// Build the Error node of an element that failed to parse: the tokens
+	/// read since <paramref name="mark"/>, then the upcoming ones up to the
+	/// next ';', newline or '}' outside of brackets. A '}' closing the
+	/// enclosing namespace or class is left to it.
+	/// </summary>
+	/// <param name="mark">The size of the arena when the element started.</param>
+	Node Parser::parseError(NodeId mark)
+	{
+		Node error = this->node(TokenType::Error);
+		NodeId const end = error.id();
+		std::uint32_t next = 0;
+		int depth = 0;
+		bool done = false;
+
+		auto skip = [&depth, &done](TokenType type)
+		{
+			if (type == TokenType::P_OPEN_PAR || type == TokenType::P_OPEN_BRACE ||
+				type == TokenType::P_OPEN_BRACKET)
+			{
+				++depth;
+			}
+			else if ((type == TokenType::P_CLOSE_PAR || type == TokenType::P_CLOSE_BRACE ||
+				type == TokenType::P_CLOSE_BRACKET) && depth > 0)
+			{
+				--depth;
+			}
+			done = depth == 0 && (type == TokenType::P_SEMICOLON ||
+				type == TokenType::P_NEWLINE || type == TokenType::P_CLOSE_BRACE);
+		};
+
+		// The terminals of the arena are in reading order; the ones already
+		// moved to a nested Error node are copies, seen at the same offsets
+		for (NodeId id = mark; id < end; ++id)
+		{
+			TokenType type = m_ast.type(id);
+
+			if (isTerminal(type) && type != TokenType::END_OF_FILE &&
+				m_ast.offset(id) >= next)
+			{
+				error << Token(type, m_ast.offset(id), m_ast.length(id), m_ast.symbol(id));
+				next = m_ast.offset(id) + m_ast.length(id);
+				skip(type);
+			}
+		}
+
+		while (!done)
+		{
+			TokenType type = m_input.peek(0, false).type;
+
+			if (type == TokenType::END_OF_FILE ||
+				(type == TokenType::P_CLOSE_BRACE && depth == 0 && error.size() != 0))
+			{
+				break;
+			}
+			error << m_input.next(false);
+			skip(type);
+		}
+
+		return error;
+	}
+
+	Node Parser::ast()
+	{
+		return Node(m_ast, m_ast.root());
+	}
+
+	/// <summary>
+	/// Get the blanks and comments of the input, once parsed in TriviaMode::FULL.
+	/// </summary>
+	TriviaTable const & Parser::trivia() const
+	{
+		return m_input.trivia();
+	}
+
+	/// <summary>
+	/// Get the documentation comment, /** ... */, right before a declaration,
+	/// or an empty string. Needs TriviaMode::FULL.
+	/// </summary>
+	std::string_view Parser::docComment(Node const & node) const
+	{
+		if (m_ast.offset(node.id()) == Ast::npos)
+		{
+			return std::string_view();
+		}
+
+		Token const *comment = m_input.trivia().docComment(m_input.source(), m_ast.offset(node.id()));
+
+		return comment ? m_input.value(*comment) : std::string_view();
+	}
+
+	Node Parser::parseFile()
+	{
+		Node file = this->node(TokenType::File);
 
 		while (m_input.peek().type != TokenType::END_OF_FILE)
 		{
-			file << this->parseFileElement();
+			this->parseElement(file, &Parser::parseFileElement);
 		}
 
 		return file;
 	}
 
-	Token Parser::parseFileElement()
+	Node Parser::parseFileElement()
 	{
-		Token elem(TokenType::FileElement);
+		Node elem = this->node(TokenType::FileElement);
 		bool needEndOfLine = false;
 
 		if (m_input.peek().type == TokenType::KW_INTERFACE)
@@ -71,13 +394,13 @@ namespace nope::dts::parser
 				elem << this->parseNamespace();
 				break;
 			case TokenType::ID:
-				if (m_input.peek().value == "global")
+				if (m_input.peek().symbol == Interner::global)
 				{
 					elem << this->parseNamespace();
 				}
 				else
 				{
-					m_input.error("Unexpected element");
+					m_input.error("Unexpected element", m_input.peek());
 				}
 				break;
 			case TokenType::KW_VAR:
@@ -98,7 +421,7 @@ namespace nope::dts::parser
 				needEndOfLine = true;
 				break;
 			default:
-				m_input.error("Unexpected element");
+				m_input.error("Unexpected element", m_input.peek());
 				break;
 			}
 		}
@@ -111,24 +434,24 @@ namespace nope::dts::parser
 		return elem;
 	}
 
-	Token Parser::parseImport()
+	Node Parser::parseImport()
 	{
-		Token import(TokenType::Import);
+		Node import = this->node(TokenType::Import);
 
 		this->nextAndCheck(import, TokenType::KW_IMPORT,
 			"Expected the 'import' keyword for and import declaration");
 
-		if (m_input.nextIf(import, TokenType::STRING_LITERAL))
+		if (this->nextIf(import, TokenType::STRING_LITERAL))
 		{
 			return import;
 		}
 
-		if (m_input.nextIf(import, TokenType::P_OPEN_BRACE))
+		if (this->nextIf(import, TokenType::P_OPEN_BRACE))
 		{
 			this->nextAndCheck(import, TokenType::ID,
 				"Expected an identifier as import name");
 
-			if (m_input.nextIf(import, TokenType::KW_AS))
+			if (this->nextIf(import, TokenType::KW_AS))
 			{
 				this->nextAndCheck(import, TokenType::ID,
 					"Expected an identifier as import alias name");
@@ -142,14 +465,11 @@ namespace nope::dts::parser
 			this->nextAndCheck(import, { TokenType::ID, TokenType::P_STAR },
 				"Expected an identifier or a '*' as import name");
 
-			if (m_input.nextIf(import, TokenType::KW_AS))
+			if (this->nextIf(import, TokenType::KW_AS))
 			{
 				this->nextAndCheck(import, TokenType::ID,
 					"Expected an identifier as import alias name");
 			}
-
-			this->nextAndCheck(import, TokenType::P_CLOSE_BRACE,
-				"Expected a closing brace '}'");
 		}
 
 		this->nextAndCheck(import, TokenType::KW_FROM,
@@ -161,9 +481,9 @@ namespace nope::dts::parser
 		return (import);
 	}
 
-	Token Parser::parseExport()
+	Node Parser::parseExport()
 	{
-		Token exp(TokenType::Export);
+		Node exp = this->node(TokenType::Export);
 
 		this->nextAndCheck(exp, TokenType::KW_EXPORT,
 			"Expected 'export' keyword");
@@ -176,20 +496,20 @@ namespace nope::dts::parser
 		return exp;
 	}
 
-	Token Parser::parseNamespace()
+	Node Parser::parseNamespace()
 	{
-		Token ns(TokenType::Namespace);
+		Node ns = this->node(TokenType::Namespace);
 
 
 		this->nextAndCheck(ns, { TokenType::KW_MODULE, TokenType::ID },
 			"Expected 'namespace' or 'module' keyword");
 
-		if (ns[0].type == TokenType::ID && ns[0].value != "global")
+		if (ns[0].type() == TokenType::ID && ns[0].symbol() != Interner::global)
 		{
 			m_input.error("Unexpected identifier");
 		}
 
-		if (ns[0].type != TokenType::ID)
+		if (ns[0].type() != TokenType::ID)
 		{
 			ns << this->parseDotId();
 		}
@@ -199,7 +519,11 @@ namespace nope::dts::parser
 
 		while (m_input.peek().type != TokenType::P_CLOSE_BRACE)
 		{
-			ns << this->parseNamespaceElement();
+			this->parseElement(ns, &Parser::parseNamespaceElement);
+			if (m_input.failed())
+			{
+				return ns;
+			}
 		}
 
 		// We know it's a P_CLOSE_BRACE
@@ -208,11 +532,11 @@ namespace nope::dts::parser
 		return ns;
 	}
 
-	Token Parser::parseNamespaceElement()
+	Node Parser::parseNamespaceElement()
 	{
-		Token elem(TokenType::NamespaceElement);
+		Node elem = this->node(TokenType::NamespaceElement);
 
-		m_input.nextIf(elem, TokenType::KW_EXPORT);
+		this->nextIf(elem, TokenType::KW_EXPORT);
 
 		switch (m_input.peek().type)
 		{
@@ -237,30 +561,28 @@ namespace nope::dts::parser
 			this->checkEndOfLine(elem);
 			break;
 		default:
-			m_input.error("Expected a class, a namespace or a type");
+			m_input.error("Expected a class, a namespace or a type", m_input.peek());
 			break;
 		}
 
 		return elem;
 	}
 
-	Token Parser::parseGlobalVariable()
+	Node Parser::parseGlobalVariable()
 	{
-		Token var(TokenType::GlobalVariable);
+		Node var = this->node(TokenType::GlobalVariable);
 
 		this->nextAndCheck(var, { TokenType::KW_VAR, TokenType::KW_CONST },
 			"Expected 'var' or 'const' keyword for file level variable declaration");
 
 		var << this->parseVariable();
 
-		this->checkEndOfLine(var);
-
 		return var;
 	}
 
-	Token Parser::parseGlobalFunction()
+	Node Parser::parseGlobalFunction()
 	{
-		Token func(TokenType::GlobalFunction);
+		Node func = this->node(TokenType::GlobalFunction);
 
 		this->nextAndCheck(func, TokenType::KW_FUNCTION,
 			"Expected 'function' keyword for file level function declaration");
@@ -270,9 +592,9 @@ namespace nope::dts::parser
 		return func;
 	}
 
-	Token Parser::parseClass()
+	Node Parser::parseClass()
 	{
-		Token clas(TokenType::Class);
+		Node clas = this->node(TokenType::Class);
 
 		this->nextAndCheck(clas, { TokenType::KW_CLASS, TokenType::KW_INTERFACE },
 			"Expected 'class' or 'interface' keyword");
@@ -287,7 +609,7 @@ namespace nope::dts::parser
 
 		clas << m_input.next();
 
-		if (clas.last().type == TokenType::KW_EXTENDS)
+		if (clas.last().type() == TokenType::KW_EXTENDS)
 		{
 			bool endExtend = false;
 
@@ -296,7 +618,7 @@ namespace nope::dts::parser
 				clas << this->parseDotId();
 				clas << m_input.next();
 				
-				if (clas.last().type == TokenType::P_GREATER_THAN)
+				if (clas.last().type() == TokenType::P_GREATER_THAN)
 				{
 					bool endGeneric = false;
 
@@ -305,32 +627,36 @@ namespace nope::dts::parser
 						clas << this->parseUnionType();
 						clas << m_input.next();
 
-						if (clas.last().type == TokenType::P_LESS_THAN)
+						if (clas.last().type() == TokenType::P_LESS_THAN)
 						{
 							endGeneric = true;
 						}
-						else
+						else if (!this->checkToken(clas.last().type(), TokenType::P_COMMA,
+							"Expected a comma after a generic's type parameter"))
 						{
-							this->checkToken(clas.last(), TokenType::P_COMMA,
-								"Expected a comma after a generic's type parameter");
+							return clas;
 						}
 					}
 					clas << m_input.next();
 				}
 
-				if (clas.last().type != TokenType::P_COMMA)
+				if (clas.last().type() != TokenType::P_COMMA)
 				{
 					endExtend = true;
 				}
 			}
 		}
 
-		this->checkToken(clas.last(), TokenType::P_OPEN_BRACE,
+		this->checkToken(clas.last().type(), TokenType::P_OPEN_BRACE,
 			"Expected a '{' for class declaration");
 
 		while (m_input.peek().type != TokenType::P_CLOSE_BRACE)
 		{
-			clas << this->parseClassElement();
+			this->parseElement(clas, &Parser::parseClassElement);
+			if (m_input.failed())
+			{
+				return clas;
+			}
 		}
 
 		// We are sure it's a P_CLOSE_BRACE
@@ -339,9 +665,9 @@ namespace nope::dts::parser
 		return clas;
 	}
 
-	Token Parser::parseClassElement()
+	Node Parser::parseClassElement()
 	{
-		Token elem(TokenType::ClassElement);
+		Node elem = this->node(TokenType::ClassElement);
 
 		if (m_input.peek().type == TokenType::P_OPEN_PAR)
 		{
@@ -349,7 +675,7 @@ namespace nope::dts::parser
 		}
 		else if (m_input.peek().type == TokenType::P_OPEN_BRACKET)
 		{
-			m_input.nextIf(elem, TokenType::KW_READONLY);
+			this->nextIf(elem, TokenType::KW_READONLY);
 
 			elem << this->parseMapObject();
 		}
@@ -360,22 +686,22 @@ namespace nope::dts::parser
 		else
 		{
 			bool isReadonly = false;
-			Token peek[4] = {
-				m_input.peek(0),
-				m_input.peek(1),
-				m_input.peek(2),
-				m_input.peek(3)
+			TokenType peek[4] = {
+				m_input.peek(0).type,
+				m_input.peek(1).type,
+				m_input.peek(2).type,
+				m_input.peek(3).type
 			};
 			int index = 0;
 
 			auto *input = &m_input;
 
 			auto check = [&elem, &peek, &index, input](TokenType type) {
-				if (peek[index].type == type &&
-					peek[index + 1].type != TokenType::P_QUESTION &&
-					peek[index + 1].type != TokenType::P_COLON &&
-					peek[index + 1].type != TokenType::P_OPEN_PAR &&
-					peek[index + 1].type != TokenType::P_GREATER_THAN)
+				if (peek[index] == type &&
+					peek[index + 1] != TokenType::P_QUESTION &&
+					peek[index + 1] != TokenType::P_COLON &&
+					peek[index + 1] != TokenType::P_OPEN_PAR &&
+					peek[index + 1] != TokenType::P_GREATER_THAN)
 				{
 					elem << input->next();
 					++index;
@@ -413,9 +739,9 @@ namespace nope::dts::parser
 		return elem;
 	}
 
-	Token Parser::parseGenericParameterPack()
+	Node Parser::parseGenericParameterPack()
 	{
-		Token gen(TokenType::GenericParameterPack);
+		Node gen = this->node(TokenType::GenericParameterPack);
 		bool end = false;
 		bool hasDefault = false;
 
@@ -428,33 +754,33 @@ namespace nope::dts::parser
 
 			gen << m_input.next();
 
-			if (gen.last().type == TokenType::P_LESS_THAN)
+			if (gen.last().type() == TokenType::P_LESS_THAN)
 			{
 				end = true;
 			}
-			else
+			else if (!this->checkToken(gen.last().type(), TokenType::P_COMMA,
+				"Expected a comma after a generic's type"))
 			{
-				this->checkToken(gen.last(), TokenType::P_COMMA,
-					"Expected a comma after a generic's type");
+				return gen;
 			}
 		}
 
 		return gen;
 	}
 
-	Token Parser::parseGenericParameter()
+	Node Parser::parseGenericParameter()
 	{
-		Token param(TokenType::GenericParameter);
+		Node param = this->node(TokenType::GenericParameter);
 
 		this->nextAndCheck(param, TokenType::ID,
 			"Expected an identifier as generic's type");
 
-		if (m_input.nextIf(param, TokenType::KW_EXTENDS))
+		if (this->nextIf(param, TokenType::KW_EXTENDS))
 		{
 			param << this->parseUnionType();
 		}
 
-		if (m_input.nextIf(param, TokenType::P_EQUAL))
+		if (this->nextIf(param, TokenType::P_EQUAL))
 		{
 			param << this->parseUnionType();
 		}
@@ -462,9 +788,9 @@ namespace nope::dts::parser
 		return param;
 	}
 
-	Token Parser::parseObjectCallable()
+	Node Parser::parseObjectCallable()
 	{
-		Token func(TokenType::ObjectCallable);
+		Node func = this->node(TokenType::ObjectCallable);
 
 		this->nextAndCheck(func, TokenType::P_OPEN_PAR,
 			"Expected an opening parenthesis after the function's name");
@@ -485,9 +811,9 @@ namespace nope::dts::parser
 		return func;
 	}
 
-	Token Parser::parseFunction()
+	Node Parser::parseFunction()
 	{
-		Token func(TokenType::Function);
+		Node func = this->node(TokenType::Function);
 
 		func << this->parseElementKey();
 		
@@ -497,7 +823,7 @@ namespace nope::dts::parser
 		}
 		else
 		{
-			m_input.nextIf(func, TokenType::P_QUESTION);
+			this->nextIf(func, TokenType::P_QUESTION);
 		}
 
 		this->nextAndCheck(func, TokenType::P_OPEN_PAR,
@@ -526,9 +852,9 @@ namespace nope::dts::parser
 		return func;
 	}
 
-	Token Parser::parseConstructor()
+	Node Parser::parseConstructor()
 	{
-		Token constructor(TokenType::Constructor);
+		Node constructor = this->node(TokenType::Constructor);
 
 		this->nextAndCheck(constructor, TokenType::KW_CONSTRUCTOR,
 			"Expected the 'constructor' keyword as a constructor name");
@@ -547,13 +873,13 @@ namespace nope::dts::parser
 		return constructor;
 	}
 
-	Token Parser::parseParameterPack()
+	Node Parser::parseParameterPack()
 	{
-		Token pack(TokenType::ParameterPack);
+		Node pack = this->node(TokenType::ParameterPack);
 
 		pack << this->parseParameter();
 
-		while (m_input.nextIf(pack, TokenType::P_COMMA))
+		while (this->nextIf(pack, TokenType::P_COMMA))
 		{
 			pack << this->parseParameter();
 		}
@@ -561,9 +887,9 @@ namespace nope::dts::parser
 		return pack;
 	}
 
-	Token Parser::parseParameter()
+	Node Parser::parseParameter()
 	{
-		Token t(TokenType::Parameter);
+		Node t = this->node(TokenType::Parameter);
 
 		// TODO: uncomment this and implement parseAssignation()
 		/*if (m_input.peek(1).type == TokenType::P_EQUAL)
@@ -571,16 +897,16 @@ namespace nope::dts::parser
 			return this->parseAssignation();
 		}*/
 
-		m_input.nextIf(t, TokenType::P_SPREAD);
+		this->nextIf(t, TokenType::P_SPREAD);
 
 		t << this->parseVariable();
 
 		return t;
 	}
 
-	Token Parser::parseMapObject()
+	Node Parser::parseMapObject()
 	{
-		Token obj(TokenType::MapObject);
+		Node obj = this->node(TokenType::MapObject);
 
 		this->nextAndCheck(obj, TokenType::P_OPEN_BRACKET,
 			"Expected a '[' at the beggining of a map property");
@@ -600,13 +926,13 @@ namespace nope::dts::parser
 		return obj;
 	}
 
-	Token Parser::parseVariable()
+	Node Parser::parseVariable()
 	{
-		Token var(TokenType::Variable);
+		Node var = this->node(TokenType::Variable);
 
 		var << this->parseElementKey();
 
-		m_input.nextIf(var, TokenType::P_QUESTION);
+		this->nextIf(var, TokenType::P_QUESTION);
 
 		this->nextAndCheck(var, TokenType::P_COLON,
 			"Expected a ':' after the variable's name");
@@ -616,9 +942,9 @@ namespace nope::dts::parser
 		return var;
 	}
 
-	Token Parser::parseTypeDef()
+	Node Parser::parseTypeDef()
 	{
-		Token def(TokenType::TypeDef);
+		Node def = this->node(TokenType::TypeDef);
 
 		
 		this->nextAndCheck(def, TokenType::KW_TYPE,
@@ -627,9 +953,9 @@ namespace nope::dts::parser
 		def << m_input.next();
 		if (def[1].isKeyword() && !def[1].isReserved())
 		{
-			def[1].type = TokenType::ID;
+			def[1].setType(TokenType::ID);
 		}
-		this->checkToken(def[1], TokenType::ID, "Expected type alias name");
+		this->checkToken(def[1].type(), TokenType::ID, "Expected type alias name");
 
 		if (m_input.peek().type == TokenType::P_GREATER_THAN)
 		{
@@ -644,9 +970,9 @@ namespace nope::dts::parser
 		return def;
 	}
 
-	Token Parser::parseFunctionTypePredicate()
+	Node Parser::parseFunctionTypePredicate()
 	{
-		Token pred(TokenType::FunctionTypePredicate);
+		Node pred = this->node(TokenType::FunctionTypePredicate);
 
 		this->nextAndCheck(pred, TokenType::ID,
 			"Expected an identifier at the beggining of a function type predicate");
@@ -659,33 +985,23 @@ namespace nope::dts::parser
 		return pred;
 	}
 
-	Token Parser::parseTypeParenthesis()
+	Node Parser::parseTypeParenthesis()
 	{
-		int level = 1;
-		int i;
+		if (m_input.peek().type != TokenType::P_OPEN_PAR)
+		{
+			m_input.error("Expected a parenthesis '('", m_input.peek());
+			return this->node(TokenType::TypeGroup);
+		}
 
-		this->checkToken(m_input.peek(), TokenType::P_OPEN_PAR,
-			"Expected a parenthesis '('");
+		Token const *after = m_input.peekAfterGroup();
 
-		for (i = 1; level > 0; ++i)
+		if (after == nullptr)
 		{
-			Token peek = m_input.peek(i);
-
-			if (peek.type == TokenType::P_OPEN_PAR)
-			{
-				level++;
-			}
-			else if (peek.type == TokenType::P_CLOSE_PAR)
-			{
-				level--;
-			}
-			else if (peek.type == TokenType::END_OF_FILE)
-			{
-				m_input.error("Unheaven number of parenthesis");
-			}
+			m_input.error("Unheaven number of parenthesis", m_input.peek());
+			return this->node(TokenType::TypeGroup);
 		}
 
-		if (m_input.peek(i).type == TokenType::P_ARROW)
+		if (after->type == TokenType::P_ARROW)
 		{
 			return this->parseLambdaType();
 		}
@@ -695,9 +1011,9 @@ namespace nope::dts::parser
 		}
 	}
 
-	Token Parser::parseTypeGroup()
+	Node Parser::parseTypeGroup()
 	{
-		Token group(TokenType::TypeGroup);
+		Node group = this->node(TokenType::TypeGroup);
 
 		this->nextAndCheck(group, TokenType::P_OPEN_PAR,
 			"Expected parenthesis '(' before a type group");
@@ -707,9 +1023,9 @@ namespace nope::dts::parser
 		this->nextAndCheck(group, TokenType::P_CLOSE_PAR,
 			"Expected parenthesis ')' after a type group");
 
-		while (m_input.nextIf(group, TokenType::P_OPEN_BRACKET))
+		while (this->nextIf(group, TokenType::P_OPEN_BRACKET))
 		{
-			m_input.nextIf(group, TokenType::ID);
+			this->nextIf(group, TokenType::ID);
 
 			this->nextAndCheck(group, TokenType::P_CLOSE_BRACKET,
 				"Expected a ']' at the end of the array");
@@ -718,24 +1034,24 @@ namespace nope::dts::parser
 		return group;
 	}
 
-	Token Parser::parseUnionType()
+	Node Parser::parseUnionType()
 	{
-		Token unionType(TokenType::UnionType);
+		Node unionType = this->node(TokenType::UnionType);
 		bool end = false;
 
 		while (end == false)
 		{
 			unionType << this->parseType();
 
-			if (!m_input.nextIf(unionType, TokenType::P_VERTICAL_BAR))
+			if (!this->nextIf(unionType, TokenType::P_VERTICAL_BAR))
 			{
 				end = true;
 			}
 		}
 
-		if (unionType.child.size() == 1)
+		if (unionType.size() == 1)
 		{
-			return unionType.child[0];
+			return unionType[0];
 		}
 		else
 		{
@@ -743,15 +1059,15 @@ namespace nope::dts::parser
 		}
 	}
 
-	Token Parser::parseType()
+	Node Parser::parseType()
 	{
-		Token type(TokenType::Type);
-		Token peek = m_input.peek();
+		Node type = this->node(TokenType::Type);
+		Token const &peek = m_input.peek();
 
 		if (peek.type == TokenType::STRING_LITERAL ||
 			peek.type == TokenType::NUMBER)
 		{
-			return m_input.next();
+			return this->node(m_input.next());
 		}
 		else if (peek.type == TokenType::P_OPEN_BRACE)
 		{
@@ -770,7 +1086,7 @@ namespace nope::dts::parser
 
 		type << this->parseDotId();
 
-		if (m_input.nextIf(type, TokenType::P_GREATER_THAN))
+		if (this->nextIf(type, TokenType::P_GREATER_THAN))
 		{
 			bool end = false;
 
@@ -778,21 +1094,23 @@ namespace nope::dts::parser
 			{
 				type << this->parseUnionType();
 
-				if (!m_input.nextIf(type, TokenType::P_COMMA))
+				if (!this->nextIf(type, TokenType::P_COMMA))
 				{
 					end = true;
 				}
 			}
 
-			this->checkToken(m_input.peek(), TokenType::P_LESS_THAN,
-				"Expected a '>' at the end of the generic");
+			if (m_input.peek().type != TokenType::P_LESS_THAN)
+			{
+				m_input.error("Expected a '>' at the end of the generic", m_input.peek());
+			}
 			
 			type << m_input.next();
 		}
 
-		while (m_input.nextIf(type, TokenType::P_OPEN_BRACKET))
+		while (this->nextIf(type, TokenType::P_OPEN_BRACKET))
 		{
-			m_input.nextIf(type, TokenType::ID);
+			this->nextIf(type, TokenType::ID);
 
 			this->nextAndCheck(type, TokenType::P_CLOSE_BRACKET,
 				"Expected a ']' at the end of the array");
@@ -801,9 +1119,9 @@ namespace nope::dts::parser
 		return type;
 	}
 
-	Token Parser::parseLambdaType()
+	Node Parser::parseLambdaType()
 	{
-		Token lambda(TokenType::LambdaType);
+		Node lambda = this->node(TokenType::LambdaType);
 
 		this->nextAndCheck(lambda, TokenType::P_OPEN_PAR, 
 			"Expected a '(' at the beggining of the lambda parameters declaration");
@@ -824,9 +1142,9 @@ namespace nope::dts::parser
 		return lambda;
 	}
 
-	Token Parser::parseAnonymousType()
+	Node Parser::parseAnonymousType()
 	{
-		Token anon(TokenType::AnonymousType);
+		Node anon = this->node(TokenType::AnonymousType);
 
 		this->nextAndCheck(anon, TokenType::P_OPEN_BRACE,
 			"Expected a '{' for anonymous type declaration");
@@ -834,6 +1152,10 @@ namespace nope::dts::parser
 		while (m_input.peek().type != TokenType::P_CLOSE_BRACE)
 		{
 			anon << this->parseClassElement();
+			if (m_input.failed())
+			{
+				return anon;
+			}
 		}
 
 		// We know it's a P_CLOSE_BRACE
@@ -842,13 +1164,13 @@ namespace nope::dts::parser
 		return anon;
 	}
 
-	Token Parser::parseDotId()
+	Node Parser::parseDotId()
 	{
-		Token dotId(TokenType::DotId);
+		Node dotId = this->node(TokenType::DotId);
 
 		this->nextAndCheck(dotId, TokenType::ID, "Expected an identifier");
 
-		while (m_input.nextIf(dotId, TokenType::P_DOT))
+		while (this->nextIf(dotId, TokenType::P_DOT))
 		{
 			this->nextAndCheck(dotId, TokenType::ID, "Expected an identifier");
 		}
@@ -856,28 +1178,36 @@ namespace nope::dts::parser
 		return dotId;
 	}
 
-	Token Parser::parseElementKey()
+	Node Parser::parseElementKey()
 	{
-		Token elem(TokenType::ElementKey);
+		Node elem = this->node(TokenType::ElementKey);
 
 		elem << m_input.next();
 
 		if (elem[0].isKeyword())
 		{
-			elem[0].type = TokenType::ID;
+			elem[0].setType(TokenType::ID);
 		}
 
-		this->checkToken(elem[0], { TokenType::ID, TokenType::NUMBER, TokenType::STRING_LITERAL },
+		this->checkToken(elem[0].type(), { TokenType::ID, TokenType::NUMBER, TokenType::STRING_LITERAL },
 			"Expected a key (identifier, string literal or number)");
 
 		return elem;
 	}
 
-	void Parser::checkEndOfLine(Token & token)
+	void Parser::checkEndOfLine(Node & node)
 	{
-		token << m_input.next(true);
+		TokenType type = m_input.peek(0, false).type;
+
+		// The closing brace of the enclosing block also ends the declaration
+		if (type == TokenType::P_CLOSE_BRACE || type == TokenType::END_OF_FILE)
+		{
+			return;
+		}
+
+		node << m_input.next(false);
 
-		this->checkToken(token.last(), { TokenType::P_SEMICOLON, TokenType::P_NEWLINE },
+		this->checkToken(node.last().type(), { TokenType::P_SEMICOLON, TokenType::P_NEWLINE },
 			"Expected a ';' or a newline at the end of the declaration");
 	}
 }
@@ -1,17 +1,32 @@
 #ifndef NOPE_DTS_PARSER_PARSER_HPP_
 # define NOPE_DTS_PARSER_PARSER_HPP_
 
+# include <cstdint>
 # include <string_view>
+# include <vector>
+# include "Ast.hpp"
+# include "Diagnostic.hpp"
 # include "Token.hpp"
 # include "Tokenizer.hpp"
 
 namespace nope::dts::parser
 {
+	/// <summary>
+	/// Recursive descent parser of TypeScript declaration files.
+	/// Errors do not unwind: the tokenizer records the first one and reads
+	/// as the end of file from then on, the element loops return early, and
+	/// the status is checked once the parse is done. Only parse() turns it
+	/// into an exception.
+	/// </summary>
 	class Parser
 	{
 	public:
+		// To be bumped on any change of the trees built, cached trees depend on it
+		static constexpr std::uint32_t version = 2;
+
 		Parser() = delete;
 		Parser(std::string_view filename);
+		Parser(Source source, TriviaMode mode = TriviaMode::FAST);
 		Parser(Parser const &that) = delete;
 		Parser(Parser &&that) = default;
 		
@@ -20,80 +35,120 @@ namespace nope::dts::parser
 		Parser &operator=(Parser const &that) = delete;
 		Parser &operator=(Parser &&that) = default;
 
+		void reset(Source source, TriviaMode mode = TriviaMode::FAST);
 		void parse();
+		bool tryParse();
+		bool edit(std::uint32_t offset, std::uint32_t removed, std::string_view inserted);
+
+		void setRecovery(bool enabled);
+		void setInterner(Interner &interner);
+		std::vector<Diagnostic> const &diagnostics() const;
 
-		Token const &ast() const;
+		Node ast();
+
+		TriviaTable const &trivia() const;
+		std::string_view docComment(Node const &node) const;
 
 	private:
-		Token parseFile();
-		Token parseFileElement();
-		Token parseImport();
-		Token parseExport();
-		Token parseNamespace();
-		Token parseNamespaceElement();
-		Token parseGlobalVariable();
-		Token parseGlobalFunction();
-		Token parseClass();
-		Token parseClassElement();
-		Token parseGenericParameterPack();
-		Token parseGenericParameter();
-		Token parseObjectCallable();
-		Token parseFunction();
-		Token parseConstructor();
-		Token parseParameterPack();
-		Token parseParameter();
-		Token parseMapObject();
-		Token parseVariable();
-		Token parseTypeDef();
-		Token parseFunctionTypePredicate();
-		Token parseTypeParenthesis();
-		Token parseTypeGroup();
-		Token parseUnionType();
-		Token parseType();
-		Token parseLambdaType();
-		Token parseAnonymousType();
-		Token parseDotId();
-		Token parseElementKey();
-
-		void checkEndOfLine(Token &token);
-
-		inline void nextAndCheck(Token & token, TokenType type, std::string_view msg)
+		void reparse();
+
+		void parseElement(Node &container, Node (Parser::*parse)());
+		Node parseError(NodeId mark);
+
+		Node parseFile();
+		Node parseFileElement();
+		Node parseImport();
+		Node parseExport();
+		Node parseNamespace();
+		Node parseNamespaceElement();
+		Node parseGlobalVariable();
+		Node parseGlobalFunction();
+		Node parseClass();
+		Node parseClassElement();
+		Node parseGenericParameterPack();
+		Node parseGenericParameter();
+		Node parseObjectCallable();
+		Node parseFunction();
+		Node parseConstructor();
+		Node parseParameterPack();
+		Node parseParameter();
+		Node parseMapObject();
+		Node parseVariable();
+		Node parseTypeDef();
+		Node parseFunctionTypePredicate();
+		Node parseTypeParenthesis();
+		Node parseTypeGroup();
+		Node parseUnionType();
+		Node parseType();
+		Node parseLambdaType();
+		Node parseAnonymousType();
+		Node parseDotId();
+		Node parseElementKey();
+
+		void checkEndOfLine(Node &node);
+
+		inline Node node(TokenType type)
+		{
+			return Node(m_ast, m_ast.create(type));
+		}
+
+		inline Node node(Token const &token)
+		{
+			return Node(m_ast, m_ast.create(token));
+		}
+
+		inline bool nextIf(Node & node, TokenType type, std::uint32_t lookAhead = 0, bool ignoreNewline = true)
+		{
+			if (m_input.peek(lookAhead, ignoreNewline).type == type)
+			{
+				node << m_input.next(ignoreNewline);
+				return true;
+			}
+			return false;
+		}
+
+		inline bool nextAndCheck(Node & node, TokenType type, std::string_view msg)
 		{
-			token << m_input.next();
+			node << m_input.next();
 
-			this->checkToken(token.last(), type, msg);
+			return this->checkToken(node.last().type(), type, msg);
 		}
 
-		inline void nextAndCheck(Token & token, std::initializer_list<TokenType> types, std::string_view msg)
+		inline bool nextAndCheck(Node & node, std::initializer_list<TokenType> types, std::string_view msg)
 		{
-			token << m_input.next();
+			node << m_input.next();
 
-			this->checkToken(token.last(), types, msg);
+			return this->checkToken(node.last().type(), types, msg);
 		}
 
-		inline void checkToken(Token const & token, TokenType type, std::string_view msg) const
+		inline bool checkToken(TokenType actual, TokenType type, std::string_view msg) const
 		{
-			if (token.type != type)
+			if (actual != type)
 			{
 				m_input.error(msg);
+				return false;
 			}
+			return true;
 		}
 
-		inline void checkToken(Token const & token, std::initializer_list<TokenType> types, std::string_view msg) const
+		inline bool checkToken(TokenType actual, std::initializer_list<TokenType> types, std::string_view msg) const
 		{
 			for (auto type : types)
 			{
-				if (token.type == type)
+				if (actual == type)
 				{
-					return;
+					return true;
 				}
 			}
 
 			m_input.error(msg);
+			return false;
 		}
 
 		Tokenizer m_input;
-		Token m_ast;
+		Ast m_ast;
+		// Whether the tree comes from a parse without errors, the only one an edit can be spliced into
+		bool m_clean;
 	};
 }
 
@@ -0,0 +1,350 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace nope::dts::parser
+{
+	namespace
+	{
+		// Value of name="..." in a triple-slash directive, or an empty string
+		std::string_view attribute(std::string_view directive, std::string_view name)
+		{
+			auto blank = [&directive](std::size_t &i)
+			{
+				while (i < directive.size() && std::isspace(static_cast<unsigned char>(directive[i])))
+				{
+					++i;
+				}
+			};
+
+			for (std::size_t at = directive.find(name); at != std::string_view::npos; at = directive.find(name, at + 1))
+			{
+				std::size_t i = at + name.size();
+
+				if (at == 0 || !std::isspace(static_cast<unsigned char>(directive[at - 1])))
+				{
+					continue;
+				}
+				blank(i);
+				if (i == directive.size() || directive[i] != '=')
+				{
+					continue;
+				}
+				++i;
+				blank(i);
+				if (i == directive.size() || (directive[i] != '"' && directive[i] != '\''))
+				{
+					continue;
+				}
+
+				std::size_t end = directive.find(directive[i], i + 1);
+
+				return end == std::string_view::npos ? std::string_view() : directive.substr(i + 1, end - i - 1);
+			}
+			return std::string_view();
+		}
+
+		char const *kindName(Project::Import::Kind kind)
+		{
+			switch (kind)
+			{
+			case Project::Import::Kind::REFERENCE:
+				return "reference";
+			case Project::Import::Kind::TYPES:
+				return "types";
+			default:
+				return "import";
+			}
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Project"/> class.
+	/// The output format and the cache of the options are not used.
+	/// </summary>
+	Project::Project(Options const &options) :
+		m_options(options),
+		m_pool(nullptr),
+		m_interner(),
+		m_files(),
+		m_known(),
+		m_mutex()
+	{
+	}
+
+	Project::~Project() noexcept
+	{
+	}
+
+	/// <summary>
+	/// Parse the roots and every file they lead to, then write the graph.
+	/// </summary>
+	/// <returns>0 if every file parsed, 1 otherwise.</returns>
+	int Project::run(std::vector<std::string> const &roots)
+	{
+		FdSink output(m_options.output);
+		std::vector<std::size_t> order;
+		std::vector<bool> seen;
+		int status = 0;
+
+		m_interner = std::make_unique<Interner>();
+		m_files.clear();
+		m_known.clear();
+		{
+			ThreadPool pool(m_options.jobs);
+
+			m_pool = &pool;
+			for (auto const &root : roots)
+			{
+				order.push_back(this->add(root));
+			}
+			// The parses queue the files they find, so this waits for the whole closure
+			pool.wait();
+			m_pool = nullptr;
+		}
+
+		// Breadth-first from the roots, in the order the files refer to each other
+		seen.assign(m_files.size(), false);
+		for (std::size_t index : order)
+		{
+			seen[index] = true;
+		}
+		for (std::size_t i = 0; i < order.size(); ++i)
+		{
+			for (auto const &import : m_files[order[i]].imports)
+			{
+				if (import.file != none && !seen[import.file])
+				{
+					seen[import.file] = true;
+					order.push_back(import.file);
+				}
+			}
+		}
+
+		std::fill(seen.begin(), seen.end(), false);
+		for (std::size_t index : order)
+		{
+			File const &file = m_files[index];
+
+			// A root given twice
+			if (seen[index])
+			{
+				continue;
+			}
+			seen[index] = true;
+			this->write(output, file);
+			if (!file.ok)
+			{
+				// Keep the diagnostics in line with the output
+				output.flush();
+				std::cerr << this->describe(file) << std::endl;
+				status = 1;
+			}
+		}
+		m_interner.reset();
+		return status;
+	}
+
+	/// <summary>
+	/// Get every file found by the last run, by order of discovery.
+	/// </summary>
+	std::deque<Project::File> const &Project::files() const
+	{
+		return m_files;
+	}
+
+	/// <summary>
+	/// Get the index of a file, queuing its parse if it is new.
+	/// </summary>
+	std::size_t Project::add(std::string const &path)
+	{
+		std::error_code error;
+		// The same file through links or another relative path is still the same file
+		fs::path canonical = fs::weakly_canonical(path, error);
+		std::string key = error ? fs::absolute(path, error).lexically_normal().string() : canonical.string();
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto found = m_known.find(key);
+
+		if (found != m_known.end())
+		{
+			return found->second;
+		}
+
+		std::size_t index = m_files.size();
+		File &file = m_files.emplace_back();
+
+		file.path = fs::path(path).lexically_normal().string();
+		m_known.emplace(std::move(key), index);
+		m_pool->submit([this, &file] { this->parse(file); });
+		return index;
+	}
+
+	/// <summary>
+	/// Parse one file, gather what it imports and references, and add the
+	/// files these resolve to. Runs on a worker.
+	/// </summary>
+	void Project::parse(File &file)
+	{
+		// One parser per worker, reused for every file it parses
+		static thread_local std::optional<Parser> parser;
+
+		try
+		{
+			if (parser)
+			{
+				parser->reset(Source(file.path), TriviaMode::FULL);
+			}
+			else
+			{
+				parser.emplace(Source(file.path), TriviaMode::FULL);
+			}
+			parser->setRecovery(m_options.recover);
+			parser->setInterner(*m_interner);
+			file.ok = parser->tryParse();
+			file.diagnostics = parser->diagnostics();
+
+			Ast const &ast = parser->ast().ast();
+
+			// The directives only count before the first statement
+			for (Token const &trivia : parser->trivia().leadingIndex(0))
+			{
+				std::string_view text = ast.source().substr(trivia.offset, trivia.length);
+				std::string_view value;
+
+				if (trivia.type != TokenType::LINE_COMMENT || text.substr(0, 3) != "///" ||
+					text.find("<reference") == std::string_view::npos)
+				{
+					continue;
+				}
+				if (!(value = attribute(text, "path")).empty())
+				{
+					file.imports.push_back({ Import::Kind::REFERENCE, std::string(value) });
+				}
+				else if (!(value = attribute(text, "types")).empty())
+				{
+					file.imports.push_back({ Import::Kind::TYPES, std::string(value) });
+				}
+			}
+
+			for (NodeId element = ast.firstChild(ast.root()); element != Ast::none; element = ast.nextSibling(element))
+			{
+				NodeId import = ast.firstChild(element);
+				NodeId specifier;
+
+				if (ast.type(element) != TokenType::FileElement || import == Ast::none ||
+					ast.type(import) != TokenType::Import)
+				{
+					continue;
+				}
+				specifier = ast.lastChild(import);
+				// Cut short by a syntax error if the string is missing
+				if (specifier == Ast::none || ast.type(specifier) != TokenType::STRING_LITERAL ||
+					ast.length(specifier) < 2)
+				{
+					continue;
+				}
+
+				std::string_view quoted = ast.value(specifier);
+
+				file.imports.push_back({ Import::Kind::IMPORT, std::string(quoted.substr(1, quoted.size() - 2)) });
+			}
+		}
+		catch (std::exception const &e)
+		{
+			file.ok = false;
+			file.error = e.what();
+		}
+
+		for (auto &import : file.imports)
+		{
+			std::string path;
+
+			switch (import.kind)
+			{
+			case Import::Kind::IMPORT:
+				path = resolve::module(import.specifier, file.path);
+				break;
+			case Import::Kind::REFERENCE:
+				path = resolve::reference(import.specifier, file.path);
+				break;
+			case Import::Kind::TYPES:
+				path = resolve::types(import.specifier, file.path);
+				break;
+			}
+			if (!path.empty())
+			{
+				import.file = this->add(path);
+			}
+		}
+	}
+
+	/// <summary>
+	/// Write a file of the graph as
+	/// {"file":..., "ok":..., "imports":[{"kind":..., "specifier":..., "file":...}, ...]},
+	/// the file of an import being null if it was not found.
+	/// </summary>
+	void Project::write(Sink &sink, File const &file) const
+	{
+		JsonEmitter json(sink, m_options.compact);
+		std::string_view const separator = m_options.compact ? "," : ", ";
+
+		sink.write("{\"file\":");
+		json.string(file.path);
+		sink.write(separator);
+		sink.write(file.ok ? "\"ok\":true" : "\"ok\":false");
+		sink.write(separator);
+		sink.write("\"imports\":[");
+		for (std::size_t i = 0; i < file.imports.size(); ++i)
+		{
+			Import const &import = file.imports[i];
+
+			if (i != 0)
+			{
+				sink.write(separator);
+			}
+			sink.write("{\"kind\":\"");
+			sink.write(kindName(import.kind));
+			sink.write("\"");
+			sink.write(separator);
+			sink.write("\"specifier\":");
+			json.string(import.specifier);
+			sink.write(separator);
+			sink.write("\"file\":");
+			if (import.file == none)
+			{
+				sink.write("null");
+			}
+			else
+			{
+				json.string(m_files[import.file].path);
+			}
+			sink.put('}');
+		}
+		sink.write("]}\n");
+	}
+
+	std::string Project::describe(File const &file) const
+	{
+		std::string text;
+
+		if (!file.error.empty())
+		{
+			return file.error;
+		}
+		for (auto const &diagnostic : file.diagnostics)
+		{
+			if (!text.empty())
+			{
+				text += '\n';
+			}
+			text += diagnostic.str();
+		}
+		return text;
+	}
+}
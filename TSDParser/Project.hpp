@@ -0,0 +1,93 @@
+#ifndef NOPE_DTS_PARSER_PROJECT_HPP_
+# define NOPE_DTS_PARSER_PROJECT_HPP_
+
+# include <cstddef>
+# include <deque>
+# include <memory>
+# include <mutex>
+# include <string>
+# include <unordered_map>
+# include <vector>
+# include "Diagnostic.hpp"
+# include "Driver.hpp"
+# include "Interner.hpp"
+# include "Sink.hpp"
+# include "ThreadPool.hpp"
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Parses root files and, transitively, every declaration file they
+	/// import or reference, and writes the module graph.
+	/// A file is queued on the pool as soon as a parsed one refers to it, and
+	/// only the first time: the files are told apart by their resolved path.
+	/// The graph is written once everything is parsed, one file per line in
+	/// breadth-first order from the roots, so that the output does not depend
+	/// on the order the files finish in.
+	/// </summary>
+	class Project
+	{
+	public:
+		static constexpr std::size_t none = ~std::size_t(0);
+
+		struct Import
+		{
+			enum class Kind
+			{
+				// import ... from "specifier"
+				IMPORT,
+				// /// <reference path="specifier"/>
+				REFERENCE,
+				// /// <reference types="specifier"/>
+				TYPES
+			};
+
+			Kind kind;
+			std::string specifier;
+			// Index of the file, or none for a module not found
+			std::size_t file = none;
+		};
+
+		struct File
+		{
+			std::string path;
+			std::vector<Import> imports;
+			std::vector<Diagnostic> diagnostics;
+			// A failure other than syntax errors, reported as is
+			std::string error;
+			bool ok = false;
+		};
+
+		Project(Options const &options);
+		Project(Project const &that) = delete;
+		Project(Project &&that) = delete;
+
+		~Project() noexcept;
+
+		Project &operator=(Project const &that) = delete;
+		Project &operator=(Project &&that) = delete;
+
+		int run(std::vector<std::string> const &roots);
+
+		std::deque<File> const &files() const;
+
+	private:
+		std::size_t add(std::string const &path);
+		void parse(File &file);
+		void write(Sink &sink, File const &file) const;
+		std::string describe(File const &file) const;
+
+		Options m_options;
+		ThreadPool *m_pool;
+		// Names of the current run, freed with it
+		std::unique_ptr<Interner> m_interner;
+
+		// Never moved once added, the workers fill them in place
+		std::deque<File> m_files;
+		// Files by canonical path
+		std::unordered_map<std::string, std::size_t> m_known;
+		std::mutex m_mutex;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_PROJECT_HPP_
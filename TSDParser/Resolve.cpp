@@ -0,0 +1,262 @@
+#include "stdafx.h"
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace nope::dts::parser::resolve
+{
+	namespace
+	{
+		bool endsWith(std::string_view text, std::string_view suffix)
+		{
+			return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+		}
+
+		bool isFile(fs::path const &path)
+		{
+			std::error_code error;
+
+			return fs::is_regular_file(path, error);
+		}
+
+		// Normalized before being looked at, so that ".." does not go through a link
+		std::string file(fs::path const &path)
+		{
+			std::string name = path.lexically_normal().string();
+
+			if (endsWith(name, input::extension))
+			{
+				return isFile(name) ? name : std::string();
+			}
+			// The declarations of a compiled module stand beside it
+			if (endsWith(name, ".js"))
+			{
+				fs::path declarations = name.substr(0, name.size() - 3) + std::string(input::extension);
+
+				if (isFile(declarations))
+				{
+					return declarations.string();
+				}
+			}
+
+			fs::path declarations = name + std::string(input::extension);
+
+			return isFile(declarations) ? declarations.string() : std::string();
+		}
+
+		// A package, or a directory with an index
+		std::string directory(fs::path const &given)
+		{
+			std::error_code error;
+			fs::path const path = given.lexically_normal();
+			fs::path const manifest = path / "package.json";
+
+			if (!fs::is_directory(path, error))
+			{
+				return std::string();
+			}
+			if (isFile(manifest))
+			{
+				try
+				{
+					std::string types = packageTypes(Source(manifest.string()).data());
+					std::string resolved = types.empty() ? std::string() : file(path / types);
+
+					if (!resolved.empty())
+					{
+						return resolved;
+					}
+				}
+				catch (std::exception const &)
+				{
+					// Unreadable, as if there were none
+				}
+			}
+
+			fs::path const index = path / "index.d.ts";
+
+			return isFile(index) ? index.string() : std::string();
+		}
+
+		std::string fileOrDirectory(fs::path const &path)
+		{
+			std::string resolved = file(path);
+
+			return resolved.empty() ? directory(path) : resolved;
+		}
+
+		// "@scope/name" is published under @types as "scope__name"
+		std::string typesName(std::string_view name)
+		{
+			std::size_t slash = name.find('/');
+
+			if (name.size() > 1 && name[0] == '@' && slash != std::string_view::npos)
+			{
+				return std::string(name.substr(1, slash - 1)) + "__" + std::string(name.substr(slash + 1));
+			}
+			return std::string(name);
+		}
+
+		std::string package(std::string_view name, std::string const &from, bool typesFirst)
+		{
+			std::error_code error;
+			fs::path const importer(from);
+			fs::path const absolute = fs::absolute(importer, error);
+
+			if (error)
+			{
+				return std::string();
+			}
+			for (fs::path dir = absolute.parent_path(); ; dir = dir.parent_path())
+			{
+				fs::path const modules = dir / "node_modules";
+
+				if (fs::is_directory(modules, error))
+				{
+					fs::path const declared = modules / std::string(name);
+					fs::path const types = modules / "@types" / typesName(name);
+					std::string resolved = fileOrDirectory(typesFirst ? types : declared);
+
+					if (resolved.empty())
+					{
+						resolved = fileOrDirectory(typesFirst ? declared : types);
+					}
+					if (!resolved.empty())
+					{
+						// Relative to the working directory, like the importer
+						return importer.is_absolute() ? resolved
+							: fs::path(resolved).lexically_relative(fs::current_path(error)).string();
+					}
+				}
+				if (!dir.has_relative_path())
+				{
+					return std::string();
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Resolve the module named in an import of the file <paramref name="from"/>.
+	/// </summary>
+	std::string module(std::string_view specifier, std::string const &from)
+	{
+		if (specifier.empty())
+		{
+			return std::string();
+		}
+		if (isRelative(specifier))
+		{
+			return fileOrDirectory(fs::path(from).parent_path() / std::string(specifier));
+		}
+		return package(specifier, from, false);
+	}
+
+	/// <summary>
+	/// Resolve a /// &lt;reference path="..."/&gt;, relative to the file
+	/// <paramref name="from"/> even without a leading "./".
+	/// </summary>
+	std::string reference(std::string_view path, std::string const &from)
+	{
+		if (path.empty())
+		{
+			return std::string();
+		}
+		return fileOrDirectory(fs::path(from).parent_path() / std::string(path));
+	}
+
+	/// <summary>
+	/// Resolve a /// &lt;reference types="..."/&gt;, looked up in @types first.
+	/// </summary>
+	std::string types(std::string_view name, std::string const &from)
+	{
+		if (name.empty())
+		{
+			return std::string();
+		}
+		return package(name, from, true);
+	}
+
+	/// <summary>
+	/// Get the "types", or else "typings", entry of a package.json.
+	/// Only the strings at the top level are looked at, escapes are kept as is.
+	/// </summary>
+	std::string packageTypes(std::string_view json)
+	{
+		std::string_view types;
+		std::string_view typings;
+		std::string_view key;
+		bool value = false;
+		int depth = 0;
+
+		for (std::size_t i = 0; i < json.size(); ++i)
+		{
+			switch (json[i])
+			{
+			case '"':
+			{
+				std::size_t end = i + 1;
+
+				while (end < json.size() && json[end] != '"')
+				{
+					end += json[end] == '\\' ? 2 : 1;
+				}
+				if (end >= json.size())
+				{
+					return std::string(!types.empty() ? types : typings);
+				}
+
+				std::string_view text = json.substr(i + 1, end - i - 1);
+
+				if (depth == 1 && value)
+				{
+					if (key == "types")
+					{
+						types = text;
+					}
+					else if (key == "typings")
+					{
+						typings = text;
+					}
+					value = false;
+				}
+				else if (depth == 1)
+				{
+					key = text;
+				}
+				i = end;
+				break;
+			}
+			case '{':
+			case '[':
+				++depth;
+				break;
+			case '}':
+			case ']':
+				--depth;
+				break;
+			case ':':
+				value = depth == 1;
+				break;
+			case ',':
+				value = false;
+				break;
+			default:
+				break;
+			}
+		}
+		return std::string(!types.empty() ? types : typings);
+	}
+
+	/// <summary>
+	/// Tell whether a module is named by a path rather than by a package name.
+	/// </summary>
+	bool isRelative(std::string_view specifier)
+	{
+		return specifier == "." || specifier == ".." ||
+			specifier.substr(0, 2) == "./" || specifier.substr(0, 3) == "../" ||
+			fs::path(std::string(specifier)).is_absolute() || specifier.substr(0, 1) == "/";
+	}
+}
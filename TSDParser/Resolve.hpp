@@ -0,0 +1,26 @@
+#ifndef NOPE_DTS_PARSER_RESOLVE_HPP_
+# define NOPE_DTS_PARSER_RESOLVE_HPP_
+
+# include <string>
+# include <string_view>
+
+/// <summary>
+/// Resolution of the modules a declaration file refers to, to the files
+/// declaring them, after the rules of the TypeScript compiler for
+/// declarations: a path gets ".d.ts" appended, or is a directory holding a
+/// package.json "types" or an index.d.ts; a bare name is looked up in the
+/// node_modules directories from the importer's up to the root, and in
+/// their @types. The resolved paths are normalized but left relative if
+/// the importer's is. An empty path means unresolved, an external module.
+/// </summary>
+namespace nope::dts::parser::resolve
+{
+	std::string module(std::string_view specifier, std::string const &from);
+	std::string reference(std::string_view path, std::string const &from);
+	std::string types(std::string_view name, std::string const &from);
+
+	std::string packageTypes(std::string_view json);
+	bool isRelative(std::string_view specifier);
+}
+
+#endif // !NOPE_DTS_PARSER_RESOLVE_HPP_
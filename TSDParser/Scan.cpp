@@ -0,0 +1,359 @@
+#include "stdafx.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+# define NOPE_DTS_SCAN_X86
+# include <immintrin.h>
+# ifdef _MSC_VER
+#  include <intrin.h>
+#  define NOPE_DTS_AVX2
+# else
+#  define NOPE_DTS_AVX2 __attribute__((target("avx2")))
+# endif
+#endif
+
+namespace nope::dts::parser::scan
+{
+	namespace
+	{
+		struct Kernels
+		{
+			std::size_t (*skipSpace)(char const *, std::size_t, std::size_t);
+			std::size_t (*skipIdentifier)(char const *, std::size_t, std::size_t);
+			std::size_t (*findCommentEnd)(char const *, std::size_t, std::size_t);
+			std::size_t (*findStringStop)(char const *, std::size_t, std::size_t, char);
+		};
+
+		// Scalar kernels, also used to finish the tail of the vector ones
+
+		std::size_t skipSpaceScalar(char const *data, std::size_t begin, std::size_t end)
+		{
+			while (begin < end && charset::isSpace(data[begin]))
+			{
+				++begin;
+			}
+			return begin;
+		}
+
+		std::size_t skipIdentifierScalar(char const *data, std::size_t begin, std::size_t end)
+		{
+			while (begin < end && charset::isIdentifier(data[begin]))
+			{
+				++begin;
+			}
+			return begin;
+		}
+
+		std::size_t findCommentEndScalar(char const *data, std::size_t begin, std::size_t end)
+		{
+			while (begin + 1 < end && (data[begin] != '*' || data[begin + 1] != '/'))
+			{
+				++begin;
+			}
+			return begin + 1 < end ? begin : end;
+		}
+
+		std::size_t findStringStopScalar(char const *data, std::size_t begin, std::size_t end, char quote)
+		{
+			while (begin < end && data[begin] != quote && data[begin] != '\\' && data[begin] != '\n')
+			{
+				++begin;
+			}
+			return begin;
+		}
+
+#ifdef NOPE_DTS_SCAN_X86
+		inline unsigned firstBit(std::uint32_t mask)
+		{
+# ifdef _MSC_VER
+			unsigned long index;
+
+			_BitScanForward(&index, mask);
+			return static_cast<unsigned>(index);
+# else
+			return static_cast<unsigned>(__builtin_ctz(mask));
+# endif
+		}
+
+		// (v - low) <= span, as unsigned bytes
+		inline __m128i inRange(__m128i v, char low, char span)
+		{
+			__m128i x = _mm_sub_epi8(v, _mm_set1_epi8(low));
+
+			return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(span)), x);
+		}
+
+		inline __m128i isSpace(__m128i v)
+		{
+			// ' ' and '\t' '\v' '\f' '\r', which surround '\n'
+			__m128i ctrl = _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), inRange(v, '\t', 4));
+
+			return _mm_or_si128(ctrl, _mm_cmpeq_epi8(v, _mm_set1_epi8(' ')));
+		}
+
+		inline __m128i isIdentifier(__m128i v)
+		{
+			__m128i alpha = inRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z' - 'a');
+			__m128i digit = inRange(v, '0', 9);
+			__m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+
+			return _mm_or_si128(_mm_or_si128(alpha, digit), other);
+		}
+
+		std::size_t skipSpaceSse2(char const *data, std::size_t begin, std::size_t end)
+		{
+			for (; begin + 16 <= end; begin += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin));
+				std::uint32_t mask = ~_mm_movemask_epi8(isSpace(v)) & 0xFFFF;
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return skipSpaceScalar(data, begin, end);
+		}
+
+		std::size_t skipIdentifierSse2(char const *data, std::size_t begin, std::size_t end)
+		{
+			for (; begin + 16 <= end; begin += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin));
+				std::uint32_t mask = ~_mm_movemask_epi8(isIdentifier(v)) & 0xFFFF;
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return skipIdentifierScalar(data, begin, end);
+		}
+
+		std::size_t findCommentEndSse2(char const *data, std::size_t begin, std::size_t end)
+		{
+			__m128i star = _mm_set1_epi8('*');
+			__m128i slash = _mm_set1_epi8('/');
+
+			for (; begin + 17 <= end; begin += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin));
+				__m128i w = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin + 1));
+				std::uint32_t mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(v, star), _mm_cmpeq_epi8(w, slash)));
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return findCommentEndScalar(data, begin, end);
+		}
+
+		std::size_t findStringStopSse2(char const *data, std::size_t begin, std::size_t end, char quote)
+		{
+			__m128i q = _mm_set1_epi8(quote);
+			__m128i bs = _mm_set1_epi8('\\');
+			__m128i nl = _mm_set1_epi8('\n');
+
+			for (; begin + 16 <= end; begin += 16)
+			{
+				__m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const *>(data + begin));
+				__m128i stop = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, q), _mm_cmpeq_epi8(v, bs)), _mm_cmpeq_epi8(v, nl));
+				std::uint32_t mask = _mm_movemask_epi8(stop);
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return findStringStopScalar(data, begin, end, quote);
+		}
+
+		NOPE_DTS_AVX2 inline __m256i inRange256(__m256i v, char low, char span)
+		{
+			__m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+
+			return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(span)), x);
+		}
+
+		NOPE_DTS_AVX2 std::size_t skipSpaceAvx2(char const *data, std::size_t begin, std::size_t end)
+		{
+			for (; begin + 32 <= end; begin += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + begin));
+				__m256i ctrl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), inRange256(v, '\t', 4));
+				__m256i space = _mm256_or_si256(ctrl, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')));
+				std::uint32_t mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(space));
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return skipSpaceSse2(data, begin, end);
+		}
+
+		NOPE_DTS_AVX2 std::size_t skipIdentifierAvx2(char const *data, std::size_t begin, std::size_t end)
+		{
+			for (; begin + 32 <= end; begin += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + begin));
+				__m256i alpha = inRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z' - 'a');
+				__m256i digit = inRange256(v, '0', 9);
+				__m256i other = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('$')));
+				__m256i id = _mm256_or_si256(_mm256_or_si256(alpha, digit), other);
+				std::uint32_t mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(id));
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return skipIdentifierSse2(data, begin, end);
+		}
+
+		NOPE_DTS_AVX2 std::size_t findCommentEndAvx2(char const *data, std::size_t begin, std::size_t end)
+		{
+			__m256i star = _mm256_set1_epi8('*');
+			__m256i slash = _mm256_set1_epi8('/');
+
+			for (; begin + 33 <= end; begin += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + begin));
+				__m256i w = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + begin + 1));
+				std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+					_mm256_and_si256(_mm256_cmpeq_epi8(v, star), _mm256_cmpeq_epi8(w, slash))));
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return findCommentEndSse2(data, begin, end);
+		}
+
+		NOPE_DTS_AVX2 std::size_t findStringStopAvx2(char const *data, std::size_t begin, std::size_t end, char quote)
+		{
+			__m256i q = _mm256_set1_epi8(quote);
+			__m256i bs = _mm256_set1_epi8('\\');
+			__m256i nl = _mm256_set1_epi8('\n');
+
+			for (; begin + 32 <= end; begin += 32)
+			{
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + begin));
+				__m256i stop = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, q), _mm256_cmpeq_epi8(v, bs)),
+					_mm256_cmpeq_epi8(v, nl));
+				std::uint32_t mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(stop));
+
+				if (mask != 0)
+				{
+					return begin + firstBit(mask);
+				}
+			}
+			return findStringStopSse2(data, begin, end, quote);
+		}
+
+		bool hasAvx2()
+		{
+# ifdef _MSC_VER
+			int info[4];
+
+			__cpuid(info, 0);
+			if (info[0] < 7)
+			{
+				return false;
+			}
+			__cpuid(info, 1);
+			// OSXSAVE and AVX, then the OS must save the YMM registers
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+			{
+				return false;
+			}
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+# else
+			// Selected during static initialization, possibly before the CPU model is
+			// initialized by the runtime, hence __builtin_cpu_init()
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+# endif
+		}
+#endif
+
+		Kernels select(Isa isa)
+		{
+			switch (isa)
+			{
+#ifdef NOPE_DTS_SCAN_X86
+			case Isa::AVX2:
+				return { skipSpaceAvx2, skipIdentifierAvx2, findCommentEndAvx2, findStringStopAvx2 };
+			case Isa::SSE2:
+				return { skipSpaceSse2, skipIdentifierSse2, findCommentEndSse2, findStringStopSse2 };
+#endif
+			default:
+				return { skipSpaceScalar, skipIdentifierScalar, findCommentEndScalar, findStringStopScalar };
+			}
+		}
+
+		Isa detect()
+		{
+#ifdef NOPE_DTS_SCAN_X86
+			return hasAvx2() ? Isa::AVX2 : Isa::SSE2;
+#else
+			return Isa::SCALAR;
+#endif
+		}
+
+		Isa g_isa = detect();
+		Kernels g_kernels = select(g_isa);
+	}
+
+	/// <summary>
+	/// Get the instruction set the kernels currently use.
+	/// </summary>
+	Isa isa()
+	{
+		return g_isa;
+	}
+
+	/// <summary>
+	/// Use the kernels of a given instruction set, e.g. to compare them.
+	/// Falls back to the best supported one below it. Not thread-safe.
+	/// </summary>
+	void force(Isa isa)
+	{
+		Isa best = detect();
+
+		g_isa = static_cast<int>(isa) < static_cast<int>(best) ? isa : best;
+		g_kernels = select(g_isa);
+	}
+
+	std::size_t skipSpace(char const *data, std::size_t begin, std::size_t end)
+	{
+		return g_kernels.skipSpace(data, begin, end);
+	}
+
+	std::size_t skipIdentifier(char const *data, std::size_t begin, std::size_t end)
+	{
+		return g_kernels.skipIdentifier(data, begin, end);
+	}
+
+	std::size_t findNewline(char const *data, std::size_t begin, std::size_t end)
+	{
+		// The C library's memchr is already vectorized on every platform we target
+		void const *found = begin < end ? std::memchr(data + begin, '\n', end - begin) : nullptr;
+
+		return found ? static_cast<std::size_t>(static_cast<char const *>(found) - data) : end;
+	}
+
+	std::size_t findCommentEnd(char const *data, std::size_t begin, std::size_t end)
+	{
+		return g_kernels.findCommentEnd(data, begin, end);
+	}
+
+	std::size_t findStringStop(char const *data, std::size_t begin, std::size_t end, char quote)
+	{
+		return g_kernels.findStringStop(data, begin, end, quote);
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef NOPE_DTS_PARSER_SCAN_HPP_
+# define NOPE_DTS_PARSER_SCAN_HPP_
+
+# include <cstddef>
+
+/// <summary>
+/// Kernels finding the end of a run of bytes for the Tokenizer.
+/// On x86 they test 16 (SSE2) or 32 (AVX2) bytes at a time, the widest set
+/// supported by the CPU being picked once at start-up; other targets use
+/// the scalar loops. Every function returns an index in [begin, end], end
+/// meaning the run reaches the end of the input, and never reads past end.
+/// </summary>
+namespace nope::dts::parser::scan
+{
+	enum class Isa
+	{
+		SCALAR,
+		SSE2,
+		AVX2
+	};
+
+	Isa isa();
+	void force(Isa isa);
+
+	// First byte that is not a blank (newlines excluded)
+	std::size_t skipSpace(char const *data, std::size_t begin, std::size_t end);
+	// First byte that cannot continue an identifier
+	std::size_t skipIdentifier(char const *data, std::size_t begin, std::size_t end);
+	// First newline
+	std::size_t findNewline(char const *data, std::size_t begin, std::size_t end);
+	// First "*/", pointing on the star
+	std::size_t findCommentEnd(char const *data, std::size_t begin, std::size_t end);
+	// First quote, backslash or newline
+	std::size_t findStringStop(char const *data, std::size_t begin, std::size_t end, char quote);
+}
+
+#endif // !NOPE_DTS_PARSER_SCAN_HPP_
@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+# include <io.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+#else
+# include <cerrno>
+# include <fcntl.h>
+# include <unistd.h>
+#endif
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Sink"/> class.
+	/// </summary>
+	/// <param name="capacity">Size of the buffer, 0 to hand every write to the destination.</param>
+	Sink::Sink(std::size_t capacity) :
+		m_buffer(capacity, '\0'),
+		m_used(0)
+	{
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="Sink"/> class.
+	/// Derived classes flush in their own destructor, the destination being gone by now.
+	/// </summary>
+	Sink::~Sink() noexcept
+	{
+	}
+
+	void Sink::write(std::string_view data)
+	{
+		if (m_used + data.size() <= m_buffer.size())
+		{
+			std::memcpy(&m_buffer[m_used], data.data(), data.size());
+			m_used += data.size();
+			return;
+		}
+		this->flush();
+		// Too large to be worth buffering
+		if (data.size() >= m_buffer.size())
+		{
+			this->consume(data);
+			return;
+		}
+		std::memcpy(&m_buffer[0], data.data(), data.size());
+		m_used = data.size();
+	}
+
+	void Sink::put(char c)
+	{
+		if (m_used == m_buffer.size())
+		{
+			this->flush();
+			if (m_buffer.empty())
+			{
+				this->consume(std::string_view(&c, 1));
+				return;
+			}
+		}
+		m_buffer[m_used++] = c;
+	}
+
+	void Sink::flush()
+	{
+		if (m_used != 0)
+		{
+			std::size_t used = m_used;
+
+			m_used = 0;
+			this->consume(std::string_view(m_buffer.data(), used));
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="FdSink"/> class.
+	/// </summary>
+	/// <param name="fd">The file descriptor.</param>
+	/// <param name="owned">Whether the descriptor is closed with the sink.</param>
+	FdSink::FdSink(int fd, bool owned, std::size_t capacity) :
+		Sink(capacity),
+		m_fd(fd),
+		m_owned(owned)
+	{
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="FdSink"/> class, truncating or creating a file.
+	/// </summary>
+	/// <param name="filename">The filename, or "-" for the standard output.</param>
+	FdSink::FdSink(std::string const &filename, std::size_t capacity) :
+		Sink(capacity),
+		m_fd(1),
+		m_owned(false)
+	{
+		if (filename == "-")
+		{
+			return;
+		}
+#ifdef _WIN32
+		m_fd = _open(filename.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+		m_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+		if (m_fd < 0)
+		{
+			throw std::runtime_error("Failed to open file: " + filename);
+		}
+		m_owned = true;
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="FdSink"/> class.
+	/// </summary>
+	FdSink::~FdSink() noexcept
+	{
+		try
+		{
+			this->flush();
+		}
+		catch (...)
+		{
+			// Nowhere left to report it
+		}
+		if (m_owned)
+		{
+#ifdef _WIN32
+			_close(m_fd);
+#else
+			::close(m_fd);
+#endif
+		}
+	}
+
+	void FdSink::consume(std::string_view chunk)
+	{
+		while (!chunk.empty())
+		{
+#ifdef _WIN32
+			int n = _write(m_fd, chunk.data(), static_cast<unsigned int>(std::min<std::size_t>(chunk.size(), 1 << 30)));
+#else
+			ssize_t n = ::write(m_fd, chunk.data(), chunk.size());
+
+			if (n < 0 && errno == EINTR)
+			{
+				continue;
+			}
+#endif
+			if (n <= 0)
+			{
+				throw std::runtime_error("Failed to write output");
+			}
+			chunk.remove_prefix(static_cast<std::size_t>(n));
+		}
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="StringSink"/> class.
+	/// </summary>
+	/// <param name="output">The string the output is appended to.</param>
+	/// <param name="reserve">Number of bytes to reserve in the string up front.</param>
+	StringSink::StringSink(std::string &output, std::size_t reserve) :
+		Sink(0),
+		m_output(output)
+	{
+		m_output.reserve(m_output.size() + reserve);
+	}
+
+	StringSink::~StringSink() noexcept
+	{
+	}
+
+	void StringSink::consume(std::string_view chunk)
+	{
+		m_output.append(chunk.data(), chunk.size());
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="CallbackSink"/> class.
+	/// </summary>
+	/// <param name="callback">Called with every chunk of output.</param>
+	CallbackSink::CallbackSink(Callback callback, std::size_t capacity) :
+		Sink(capacity),
+		m_callback(std::move(callback))
+	{
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="CallbackSink"/> class.
+	/// </summary>
+	CallbackSink::~CallbackSink() noexcept
+	{
+		try
+		{
+			this->flush();
+		}
+		catch (...)
+		{
+			// Nowhere left to report it
+		}
+	}
+
+	void CallbackSink::consume(std::string_view chunk)
+	{
+		m_callback(chunk);
+	}
+}
@@ -0,0 +1,102 @@
+#ifndef NOPE_DTS_PARSER_SINK_HPP_
+# define NOPE_DTS_PARSER_SINK_HPP_
+
+# include <cstddef>
+# include <functional>
+# include <string>
+# include <string_view>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Buffered output the emitters write into.
+	/// Writes are gathered in a fixed-size buffer and handed to the
+	/// destination by chunks, so serializing a tree costs one copy of the
+	/// output and no allocation beyond the buffer itself.
+	/// </summary>
+	class Sink
+	{
+	public:
+		static constexpr std::size_t defaultCapacity = 64 * 1024;
+
+		Sink(std::size_t capacity = defaultCapacity);
+		Sink(Sink const &that) = delete;
+		Sink(Sink &&that) = delete;
+
+		virtual ~Sink() noexcept;
+
+		Sink &operator=(Sink const &that) = delete;
+		Sink &operator=(Sink &&that) = delete;
+
+		void write(std::string_view data);
+		void put(char c);
+		void flush();
+
+	protected:
+		// Deliver a chunk of output to the destination
+		virtual void consume(std::string_view chunk) = 0;
+
+	private:
+		std::string m_buffer;
+		std::size_t m_used;
+	};
+
+	/// <summary>
+	/// Sink writing to a file descriptor, optionally closed on destruction.
+	/// </summary>
+	class FdSink : public Sink
+	{
+	public:
+		FdSink(int fd, bool owned = false, std::size_t capacity = defaultCapacity);
+		FdSink(std::string const &filename, std::size_t capacity = defaultCapacity);
+
+		~FdSink() noexcept override;
+
+	protected:
+		void consume(std::string_view chunk) override;
+
+	private:
+		int m_fd;
+		bool m_owned;
+	};
+
+	/// <summary>
+	/// Sink appending to a caller-owned string.
+	/// The buffer is bypassed: the string is the buffer.
+	/// </summary>
+	class StringSink : public Sink
+	{
+	public:
+		StringSink(std::string &output, std::size_t reserve = 0);
+
+		~StringSink() noexcept override;
+
+	protected:
+		void consume(std::string_view chunk) override;
+
+	private:
+		std::string &m_output;
+	};
+
+	/// <summary>
+	/// Sink handing every chunk to a callback.
+	/// The chunk is only valid for the duration of the call.
+	/// </summary>
+	class CallbackSink : public Sink
+	{
+	public:
+		using Callback = std::function<void(std::string_view)>;
+
+		CallbackSink(Callback callback, std::size_t capacity = defaultCapacity);
+
+		~CallbackSink() noexcept override;
+
+	protected:
+		void consume(std::string_view chunk) override;
+
+	private:
+		Callback m_callback;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_SINK_HPP_
@@ -0,0 +1,297 @@
+#include "stdafx.h"
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef _WIN32
+# define WIN32_LEAN_AND_MEAN
+# define NOMINMAX
+# include <windows.h>
+# include <io.h>
+# include <fcntl.h>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Source"/> class.
+	/// </summary>
+	/// <param name="filename">The filename, or "-" for the standard input.</param>
+	Source::Source(std::string_view filename) :
+		m_name(filename),
+		m_buffer(),
+		m_data(""),
+		m_size(0),
+		m_storage(Storage::OWNED)
+	{
+		if (m_name != "-" && this->map())
+		{
+			return;
+		}
+		this->read();
+	}
+
+	Source::Source(std::string_view name, Storage storage) :
+		m_name(name),
+		m_buffer(),
+		m_data(""),
+		m_size(0),
+		m_storage(storage)
+	{
+	}
+
+	Source::Source(Source &&that) noexcept :
+		m_name(std::move(that.m_name)),
+		m_buffer(std::move(that.m_buffer)),
+		m_data(that.m_data),
+		m_size(that.m_size),
+		m_storage(that.m_storage)
+	{
+		// Moving the string may have moved its characters
+		if (m_storage == Storage::OWNED)
+		{
+			m_data = m_buffer.data();
+		}
+		that.m_data = "";
+		that.m_size = 0;
+		that.m_storage = Storage::OWNED;
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="Source"/> class.
+	/// </summary>
+	Source::~Source() noexcept
+	{
+		this->release();
+	}
+
+	Source &Source::operator=(Source &&that) noexcept
+	{
+		if (this != &that)
+		{
+			this->release();
+			m_name = std::move(that.m_name);
+			m_buffer = std::move(that.m_buffer);
+			m_data = that.m_storage == Storage::OWNED ? m_buffer.data() : that.m_data;
+			m_size = that.m_size;
+			m_storage = that.m_storage;
+			that.m_data = "";
+			that.m_size = 0;
+			that.m_storage = Storage::OWNED;
+		}
+		return *this;
+	}
+
+	/// <summary>
+	/// Make a source over text owned by the caller, which must outlive the
+	/// source and everything parsed from it. Nothing is copied.
+	/// </summary>
+	/// <param name="buffer">The text.</param>
+	/// <param name="name">The name used in the diagnostics.</param>
+	Source Source::borrow(std::string_view buffer, std::string_view name)
+	{
+		Source source(name, Storage::BORROWED);
+
+		source.m_data = buffer.data();
+		source.m_size = buffer.size();
+		return source;
+	}
+
+	/// <summary>
+	/// Make a source taking ownership of <paramref name="text"/>.
+	/// </summary>
+	/// <param name="text">The text.</param>
+	/// <param name="name">The name used in the diagnostics.</param>
+	Source Source::own(std::string text, std::string_view name)
+	{
+		Source source(name, Storage::OWNED);
+
+		source.m_buffer = std::move(text);
+		source.m_data = source.m_buffer.data();
+		source.m_size = source.m_buffer.size();
+		return source;
+	}
+
+	std::string const &Source::name() const
+	{
+		return m_name;
+	}
+
+	std::string_view Source::data() const
+	{
+		return std::string_view(m_data, m_size);
+	}
+
+	std::size_t Source::size() const
+	{
+		return m_size;
+	}
+
+	Source::Storage Source::storage() const
+	{
+		return m_storage;
+	}
+
+	bool Source::mapped() const
+	{
+		return m_storage == Storage::MAPPED;
+	}
+
+	/// <summary>
+	/// Try to map the file in memory.
+	/// </summary>
+	/// <returns>false if the file is not a regular file and must be streamed instead.</returns>
+	bool Source::map()
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileA(m_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw std::runtime_error("Failed to open file: " + m_name);
+		}
+
+		LARGE_INTEGER size;
+
+		if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size))
+		{
+			CloseHandle(file);
+			return false;
+		}
+		if (size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return true;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+		// The view keeps the mapping alive on its own
+		if (mapping)
+		{
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+
+		if (view == nullptr)
+		{
+			return false;
+		}
+
+		m_data = static_cast<char const *>(view);
+		m_size = static_cast<std::size_t>(size.QuadPart);
+		m_storage = Storage::MAPPED;
+		return true;
+#else
+		int fd = ::open(m_name.c_str(), O_RDONLY);
+
+		if (fd < 0)
+		{
+			throw std::runtime_error("Failed to open file: " + m_name);
+		}
+
+		struct stat st;
+
+		if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+		{
+			::close(fd);
+			return false;
+		}
+		if (st.st_size == 0)
+		{
+			::close(fd);
+			return true;
+		}
+
+		void *view = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+		::close(fd);
+		if (view == MAP_FAILED)
+		{
+			return false;
+		}
+		::madvise(view, static_cast<std::size_t>(st.st_size), MADV_SEQUENTIAL);
+
+		m_data = static_cast<char const *>(view);
+		m_size = static_cast<std::size_t>(st.st_size);
+		m_storage = Storage::MAPPED;
+		return true;
+#endif
+	}
+
+	/// <summary>
+	/// Stream the whole input into the owned buffer.
+	/// </summary>
+	void Source::read()
+	{
+		std::FILE *file = stdin;
+
+		if (m_name != "-")
+		{
+			file = std::fopen(m_name.c_str(), "rb");
+		}
+#ifdef _WIN32
+		else
+		{
+			_setmode(_fileno(stdin), _O_BINARY);
+		}
+#endif
+
+		if (file == nullptr)
+		{
+			throw std::runtime_error("Failed to open file: " + m_name);
+		}
+
+		std::size_t const chunk = 64 * 1024;
+		std::size_t size = 0;
+
+		for (;;)
+		{
+			m_buffer.resize(size + chunk);
+
+			std::size_t len = std::fread(&m_buffer[size], 1, chunk, file);
+
+			size += len;
+			if (len < chunk)
+			{
+				break;
+			}
+		}
+
+		bool failed = std::ferror(file) != 0;
+
+		if (file != stdin)
+		{
+			std::fclose(file);
+		}
+		if (failed)
+		{
+			throw std::runtime_error("Failed to read file: " + m_name);
+		}
+
+		m_buffer.resize(size);
+		m_data = m_buffer.data();
+		m_size = size;
+	}
+
+	void Source::release() noexcept
+	{
+		if (m_storage == Storage::MAPPED)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(m_data);
+#else
+			::munmap(const_cast<char *>(m_data), m_size);
+#endif
+		}
+		m_data = "";
+		m_size = 0;
+		m_storage = Storage::OWNED;
+	}
+}
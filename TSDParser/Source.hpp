@@ -0,0 +1,65 @@
+#ifndef NOPE_DTS_PARSER_SOURCE_HPP_
+# define NOPE_DTS_PARSER_SOURCE_HPP_
+
+# include <cstddef>
+# include <string>
+# include <string_view>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Read-only view over the content of an input file.
+	/// Regular files are memory-mapped and scanned in place, so token values
+	/// point straight into the mapping. Inputs that cannot be mapped (pipes,
+	/// character devices, or "-" for the standard input) are streamed into
+	/// an owned buffer instead. Text already in memory can be borrowed, or
+	/// handed over, without touching the filesystem.
+	/// </summary>
+	class Source
+	{
+	public:
+		enum class Storage
+		{
+			OWNED,
+			MAPPED,
+			BORROWED
+		};
+
+		Source() = delete;
+		Source(std::string_view filename);
+		Source(Source const &that) = delete;
+		Source(Source &&that) noexcept;
+
+		~Source() noexcept;
+
+		Source &operator=(Source const &that) = delete;
+		Source &operator=(Source &&that) noexcept;
+
+		static Source borrow(std::string_view buffer, std::string_view name = "<memory>");
+		static Source own(std::string text, std::string_view name = "<memory>");
+
+		std::string const &name() const;
+		std::string_view data() const;
+		std::size_t size() const;
+
+		Storage storage() const;
+		bool mapped() const;
+
+	private:
+		Source(std::string_view name, Storage storage);
+
+		bool map();
+		void read();
+		void release() noexcept;
+
+		std::string m_name;
+		std::string m_buffer;
+
+		char const *m_data;
+		std::size_t m_size;
+
+		Storage m_storage;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_SOURCE_HPP_
@@ -3,7 +3,15 @@
 namespace nope::dts::parser::error
 {
 	Syntax::Syntax(std::string const &message) noexcept :
-		m_message(message)
+		m_message(message),
+		m_diagnostic()
+	{
+		m_diagnostic.message = message;
+	}
+
+	Syntax::Syntax(Diagnostic const &diagnostic) noexcept :
+		m_message(diagnostic.str()),
+		m_diagnostic(diagnostic)
 	{
 	}
 
@@ -15,4 +23,9 @@ namespace nope::dts::parser::error
 	{
 		return m_message.c_str();
 	}
+
+	Diagnostic const &Syntax::diagnostic() const noexcept
+	{
+		return m_diagnostic;
+	}
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 # include <exception>
 # include <string>
+# include "Diagnostic.hpp"
 
 namespace nope::dts::parser::error
 {
@@ -10,13 +11,16 @@ namespace nope::dts::parser::error
 	{
 	public:
 		Syntax(std::string const &message) noexcept;
+		Syntax(Diagnostic const &diagnostic) noexcept;
 
 		~Syntax() noexcept override;
 
 		const char *what() const noexcept override;
+		Diagnostic const &diagnostic() const noexcept;
 
 	private:
 		std::string m_message;
+		Diagnostic m_diagnostic;
 	};
 }
 
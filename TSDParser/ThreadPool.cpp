@@ -0,0 +1,153 @@
+#include "stdafx.h"
+
+namespace nope::dts::parser
+{
+	namespace
+	{
+		// Set on the workers, so tasks submitted from a task go to the worker's own queue
+		thread_local ThreadPool const *currentPool = nullptr;
+		thread_local std::size_t currentIndex = 0;
+	}
+
+	/// <summary>
+	/// Initializes a new instance of the <see cref="ThreadPool"/> class.
+	/// </summary>
+	/// <param name="threads">Number of workers, 0 for one per hardware thread.</param>
+	ThreadPool::ThreadPool(std::size_t threads) :
+		m_queues(),
+		m_threads(),
+		m_mutex(),
+		m_wake(),
+		m_idle(),
+		m_queued(0),
+		m_pending(0),
+		m_next(0),
+		m_stop(false)
+	{
+		if (threads == 0)
+		{
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		m_queues.reserve(threads);
+		for (std::size_t i = 0; i < threads; ++i)
+		{
+			m_queues.push_back(std::make_unique<Queue>());
+		}
+		m_threads.reserve(threads);
+		for (std::size_t i = 0; i < threads; ++i)
+		{
+			m_threads.emplace_back(&ThreadPool::work, this, i);
+		}
+	}
+
+	/// <summary>
+	/// Finalizes an instance of the <see cref="ThreadPool"/> class.
+	/// The tasks already submitted are run before the workers exit.
+	/// </summary>
+	ThreadPool::~ThreadPool() noexcept
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (auto &thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	std::size_t ThreadPool::size() const
+	{
+		return m_threads.size();
+	}
+
+	void ThreadPool::submit(Task task)
+	{
+		std::size_t index;
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			index = currentPool == this ? currentIndex : m_next++ % m_queues.size();
+			++m_queued;
+			++m_pending;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_queues[index]->mutex);
+
+			m_queues[index]->tasks.push_back(std::move(task));
+		}
+		m_wake.notify_one();
+	}
+
+	/// <summary>
+	/// Block until every submitted task is finished.
+	/// </summary>
+	void ThreadPool::wait()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		m_idle.wait(lock, [this] { return m_pending == 0; });
+	}
+
+	void ThreadPool::work(std::size_t index)
+	{
+		currentPool = this;
+		currentIndex = index;
+
+		for (;;)
+		{
+			Task task;
+
+			if (this->pop(index, task))
+			{
+				task();
+
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (--m_pending == 0)
+				{
+					m_idle.notify_all();
+				}
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_mutex);
+
+			m_wake.wait(lock, [this] { return m_stop || m_queued != 0; });
+			if (m_stop && m_queued == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	/// <summary>
+	/// Take a task from the worker's own queue, or steal one from another queue.
+	/// </summary>
+	bool ThreadPool::pop(std::size_t index, Task &task)
+	{
+		for (std::size_t i = 0; i < m_queues.size(); ++i)
+		{
+			Queue &queue = *m_queues[(index + i) % m_queues.size()];
+			std::lock_guard<std::mutex> lock(queue.mutex);
+
+			if (queue.tasks.empty())
+			{
+				continue;
+			}
+			// Thieves also take the oldest task: submitted largest first, it is the one worth moving
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+
+			std::lock_guard<std::mutex> count(m_mutex);
+
+			--m_queued;
+			return true;
+		}
+		return false;
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef NOPE_DTS_PARSER_THREAD_POOL_HPP_
+# define NOPE_DTS_PARSER_THREAD_POOL_HPP_
+
+# include <condition_variable>
+# include <cstddef>
+# include <deque>
+# include <functional>
+# include <memory>
+# include <mutex>
+# include <thread>
+# include <vector>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Fixed set of worker threads with one task queue each.
+	/// A worker runs its own queue in submission order and, once it is empty,
+	/// steals the oldest task of another queue, so uneven tasks still keep
+	/// every core busy and tasks submitted largest first are stolen largest
+	/// first. Tasks must not throw.
+	/// </summary>
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void()>;
+
+		ThreadPool(std::size_t threads = 0);
+		ThreadPool(ThreadPool const &that) = delete;
+		ThreadPool(ThreadPool &&that) = delete;
+
+		~ThreadPool() noexcept;
+
+		ThreadPool &operator=(ThreadPool const &that) = delete;
+		ThreadPool &operator=(ThreadPool &&that) = delete;
+
+		std::size_t size() const;
+
+		void submit(Task task);
+		void wait();
+
+	private:
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Task> tasks;
+		};
+
+		void work(std::size_t index);
+		bool pop(std::size_t index, Task &task);
+
+		std::vector<std::unique_ptr<Queue>> m_queues;
+		std::vector<std::thread> m_threads;
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_idle;
+		// Tasks waiting in a queue, and tasks submitted but not finished yet
+		std::size_t m_queued;
+		std::size_t m_pending;
+		std::size_t m_next;
+		bool m_stop;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_THREAD_POOL_HPP_
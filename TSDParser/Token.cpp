@@ -2,16 +2,22 @@
 
 namespace nope::dts::parser
 {
-	Token::Token(TokenType t, std::string_view val) :
+	Token::Token(TokenType t, std::size_t offset, std::size_t length, Symbol symbol) :
 		type(t),
-		value(val),
-		child()
+		offset(static_cast<std::uint32_t>(offset)),
+		length(static_cast<std::uint32_t>(length)),
+		symbol(symbol)
 	{
 	}
 
+	/// <summary>
+	/// Compare the type and the name of two tokens, from any files sharing an
+	/// interner. Only the names are interned: literals and comments have no
+	/// symbol and compare equal by type alone, see <see cref="sameText"/>.
+	/// </summary>
 	bool Token::operator==(Token const & that) const
 	{
-		return type == that.type && value == that.value;
+		return type == that.type && symbol == that.symbol;
 	}
 
 	bool Token::operator!=(Token const & that) const
@@ -20,9 +26,59 @@ namespace nope::dts::parser
 	}
 
 	bool Token::isTerminal() const
+	{
+		return parser::isTerminal(type);
+	}
+
+	/// <summary>
+	/// Order tokens by type, then by symbol: an order of the names, not an alphabetical one.
+	/// </summary>
+	bool Token::operator<(Token const & that) const
+	{
+		if (type < that.type)
+		{
+			return true;
+		}
+		if (type == that.type)
+		{
+			return symbol < that.symbol;
+		}
+		return false;
+	}
+
+	/// <summary>
+	/// Compare the type and the text of two tokens, each read in its own source.
+	/// Names are compared through their symbols, the other tokens byte by byte.
+	/// </summary>
+	bool Token::sameText(Token const &that, std::string_view source, std::string_view thatSource) const
+	{
+		if (type != that.type)
+		{
+			return false;
+		}
+		if (symbol != 0 || that.symbol != 0)
+		{
+			return symbol == that.symbol;
+		}
+		return source.substr(offset, length) == thatSource.substr(that.offset, that.length);
+	}
+
+	bool Token::isKeyword() const
+	{
+		return parser::isKeyword(type);
+	}
+
+	bool Token::isReserved() const
+	{
+		return parser::isReserved(type);
+	}
+
+	bool isTerminal(TokenType type)
 	{
 		switch (type)
 		{
+		// Stray characters, only found in the Error nodes of the recovery mode
+		case TokenType::UNKNOWN:
 		case TokenType::END_OF_FILE:
 		case TokenType::ID:
 		case TokenType::BLANK:
@@ -39,6 +95,7 @@ namespace nope::dts::parser
 		case TokenType::KW_IMPORT:
 		case TokenType::KW_IN:
 		case TokenType::KW_TYPEOF:
+		case TokenType::KW_TYPE:
 		case TokenType::KW_KEYOF:
 		case TokenType::KW_VAR:
 		case TokenType::KW_IMPLEMENTS:
@@ -81,55 +138,9 @@ namespace nope::dts::parser
 		}
 	}
 
-	bool Token::operator<(Token const & that) const
-	{
-		if (type < that.type)
-		{
-			return true;
-		}
-		if (type == that.type)
-		{
-			return value < that.value;
-		}
-		return false;
-	}
-
-	Token & Token::operator<<(Token &&children)
-	{
-		std::cout << children.type << " => " << children.value << '\n';
-		child.push_back(std::move(children));
-
-		return *this;
-	}
-
-	Token const & Token::operator[](std::size_t i) const
-	{
-		return child[i];
-	}
-
-	Token & Token::operator[](std::size_t i)
-	{
-		return child[i];
-	}
-
-	std::size_t Token::size() const
-	{
-		return child.size();
-	}
-
-	Token const & Token::last() const
-	{
-		return child.back();
-	}
-
-	Token & Token::last()
+	bool isKeyword(TokenType type)
 	{
-		return child.back();
-	}
-
-	bool Token::isKeyword() const
-	{
-		switch (this->type)
+		switch (type)
 		{
 		case TokenType::KW_CLASS:
 		case TokenType::KW_INTERFACE:
@@ -161,9 +172,9 @@ namespace nope::dts::parser
 		}
 	}
 
-	bool Token::isReserved() const
+	bool isReserved(TokenType type)
 	{
-		switch (this->type)
+		switch (type)
 		{
 		case TokenType::KW_CLASS:
 		case TokenType::KW_CONST:
@@ -181,343 +192,199 @@ namespace nope::dts::parser
 		}
 	}
 
-	std::string Token::json() const
-	{
-		std::stringstream ss;
-
-		ss << "{\"type\":\"" << this->type << "\", ";
-		
-		if (this->isTerminal())
-		{
-			ss << "\"value\":\"" << this->value << "\"}";
-		}
-		else
-		{
-			ss << "\"child\":[";
-
-			for (std::size_t i = 0; i < child.size(); ++i)
-			{
-				if (i != 0)
-				{
-					ss << ", ";
-				}
-				ss << child[i].json();
-			}
-			ss << "]}";
-		}
-		return ss.str();
-	}
-
-	std::string Token::code() const
-	{
-
-		if (this->isTerminal())
-		{
-			return std::string(this->value);
-		}
-
-		std::stringstream ss;
-
-		for (std::size_t i = 0; i < child.size(); ++i)
-		{
-			if (i != 0)
-			{
-				ss << ' ';
-			}
-			ss << child[i].code();
-		}
-
-		return ss.str();
-	}
-
-	std::string Token::xml() const
-	{
-		std::stringstream ss;
-
-		ss << '<' << this->type;
-
-		if (this->isTerminal())
-		{
-			 ss << " value=\"" << this->value << "\"/>";
-		}
-		else
-		{
-			ss << '>';
-			for (auto const &c : this->child)
-			{
-				ss << c.xml();
-			}
-			ss << "</" << this->type << '>';
-		}
-
-		return ss.str();
-	}
-
 	bool operator<(TokenType l, TokenType r)
 	{
 		return static_cast<int>(l) < static_cast<int>(r);
 	}
 
-	std::ostream & operator<<(std::ostream & os, TokenType t)
+	/// <summary>
+	/// Get the name of a token type, or an empty string for an out of range value.
+	/// </summary>
+	std::string_view name(TokenType t)
 	{
-		std::string s;
-
 		switch (t)
 		{
 		case TokenType::UNKNOWN:
-			s = "UNKNOWN";
-			break;
+			return "UNKNOWN";
 		case TokenType::END_OF_FILE:
-			s = "EOF";
-			break;
+			return "EOF";
 		case TokenType::ID:
-			s = "ID";
-			break;
+			return "ID";
 		case TokenType::BLANK:
-			s = "BLANK";
-			break;
+			return "BLANK";
 		case TokenType::LINE_COMMENT:
-			s = "LINE_COMMENT";
-			break;
+			return "LINE_COMMENT";
 		case TokenType::BLOCK_COMMENT:
-			s = "BLOCK_COMMENT";
-			break;
+			return "BLOCK_COMMENT";
 		case TokenType::KW_CLASS:
-			s = "KW_CLASS";
-			break;
+			return "KW_CLASS";
 		case TokenType::KW_INTERFACE:
-			s = "KW_INTERFACE";
-			break;
+			return "KW_INTERFACE";
 		case TokenType::KW_CONST:
-			s = "KW_CONST";
-			break;
+			return "KW_CONST";
 		case TokenType::KW_ENUM:
-			s = "KW_ENUM";
-			break;
+			return "KW_ENUM";
 		case TokenType::KW_EXPORT:
-			s = "KW_EXPORT";
-			break;
+			return "KW_EXPORT";
 		case TokenType::KW_EXTENDS:
-			s = "KW_EXTENDS";
-			break;
+			return "KW_EXTENDS";
 		case TokenType::KW_FUNCTION:
-			s = "KW_FUNCTION";
-			break;
+			return "KW_FUNCTION";
 		case TokenType::KW_CONSTRUCTOR:
-			s = "KW_CONSTRUCTOR";
-			break;
+			return "KW_CONSTRUCTOR";
 		case TokenType::KW_IMPORT:
-			s = "KW_IMPORT";
-			break;
+			return "KW_IMPORT";
 		case TokenType::KW_IN:
-			s = "KW_IN";
-			break;
+			return "KW_IN";
 		case TokenType::KW_TYPEOF:
-			s = "KW_TYPEOF";
-			break;
+			return "KW_TYPEOF";
 		case TokenType::KW_TYPE:
-			s = "KW_TYPE";
-			break;
+			return "KW_TYPE";
 		case TokenType::KW_KEYOF:
-			s = "KW_KEYOF";
-			break;
+			return "KW_KEYOF";
 		case TokenType::KW_VAR:
-			s = "KW_VAR";
-			break;
+			return "KW_VAR";
 		case TokenType::KW_IMPLEMENTS:
-			s = "KW_IMPLEMENTS";
-			break;
+			return "KW_IMPLEMENTS";
 		case TokenType::KW_VISIBILITY:
-			s = "KW_VISIBILITY";
-			break;
+			return "KW_VISIBILITY";
 		case TokenType::KW_STATIC:
-			s = "KW_STATIC";
-			break;
+			return "KW_STATIC";
 		case TokenType::KW_READONLY:
-			s = "KW_READONLY";
-			break;
+			return "KW_READONLY";
 		case TokenType::KW_AS:
-			s = "KW_AS";
-			break;
+			return "KW_AS";
 		case TokenType::KW_IS:
-			s = "KW_IS";
-			break;
+			return "KW_IS";
 		case TokenType::KW_DECLARE:
-			s = "KW_DECLARE";
-			break;
+			return "KW_DECLARE";
 		case TokenType::KW_FROM:
-			s = "KW_FROM";
-			break;
+			return "KW_FROM";
 		case TokenType::KW_MODULE:
-			s = "KW_MODULE";
-			break;
+			return "KW_MODULE";
 		case TokenType::KW_REQUIRE:
-			s = "KW_REQUIRE";
-			break;
+			return "KW_REQUIRE";
 		case TokenType::P_COLON:
-			s = "P_COLON";
-			break;
+			return "P_COLON";
 		case TokenType::P_SEMICOLON:
-			s = "P_SEMICOLON";
-			break;
+			return "P_SEMICOLON";
 		case TokenType::P_NEWLINE:
-			s = "P_NEWLINE";
-			break;
+			return "P_NEWLINE";
 		case TokenType::P_ARROW:
-			s = "P_ARROW";
-			break;
+			return "P_ARROW";
 		case TokenType::P_SPREAD:
-			s = "P_SPREAD";
-			break;
+			return "P_SPREAD";
 		case TokenType::P_DOT:
-			s = "P_DOT";
-			break;
+			return "P_DOT";
 		case TokenType::P_COMMA:
-			s = "P_COMMA";
-			break;
+			return "P_COMMA";
 		case TokenType::P_SLASH:
-			s = "P_SLASH";
-			break;
+			return "P_SLASH";
 		case TokenType::P_ANTISLASH:
-			s = "P_ANTISLASH";
-			break;
+			return "P_ANTISLASH";
 		case TokenType::P_QUESTION:
-			s = "P_QUESTION";
-			break;
+			return "P_QUESTION";
 		case TokenType::P_STAR:
-			s = "P_STAR";
-			break;
+			return "P_STAR";
 		case TokenType::P_OPEN_PAR:
-			s = "P_OPEN_PAR";
-			break;
+			return "P_OPEN_PAR";
 		case TokenType::P_CLOSE_PAR:
-			s = "P_CLOSE_PAR";
-			break;
+			return "P_CLOSE_PAR";
 		case TokenType::P_OPEN_BRACE:
-			s = "P_OPEN_BRACE";
-			break;
+			return "P_OPEN_BRACE";
 		case TokenType::P_CLOSE_BRACE:
-			s = "P_CLOSE_BRACE";
-			break;
+			return "P_CLOSE_BRACE";
 		case TokenType::P_OPEN_BRACKET:
-			s = "P_OPEN_BRACKET";
-			break;
+			return "P_OPEN_BRACKET";
 		case TokenType::P_CLOSE_BRACKET:
-			s = "P_CLOSE_BRACKET";
-			break;
+			return "P_CLOSE_BRACKET";
 		case TokenType::P_EQUAL:
-			s = "P_EQUAL";
-			break;
+			return "P_EQUAL";
 		case TokenType::P_VERTICAL_BAR:
-			s = "P_VERTICAL_BAR";
-			break;
+			return "P_VERTICAL_BAR";
 		case TokenType::P_GREATER_THAN:
-			s = "P_GREATER_THAN";
-			break;
+			return "P_GREATER_THAN";
 		case TokenType::P_LESS_THAN:
-			s = "P_LESS_THAN";
-			break;
+			return "P_LESS_THAN";
 		case TokenType::P_AMPERSAND:
-			s = "P_AMPERSAND";
-			break;
+			return "P_AMPERSAND";
 		case TokenType::STRING_LITERAL:
-			s = "STRING_LITERAL";
-			break;
+			return "STRING_LITERAL";
 		case TokenType::NUMBER:
-			s = "NUMBER";
-			break;
+			return "NUMBER";
 		case TokenType::ElementKey:
-			s = "ElementKey";
-			break;
+			return "ElementKey";
 		case TokenType::DotId:
-			s = "DotId";
-			break;
+			return "DotId";
 		case TokenType::AnonymousType:
-			s = "AnonymousType";
-			break;
+			return "AnonymousType";
 		case TokenType::TypeDef:
-			s = "TypeDef";
-			break;
+			return "TypeDef";
 		case TokenType::Type:
-			s = "Type";
-			break;
+			return "Type";
 		case TokenType::LambdaType:
-			s = "LambdaType";
-			break;
+			return "LambdaType";
 		case TokenType::TypeGroup:
-			s = "TypeGroup";
-			break;
+			return "TypeGroup";
 		case TokenType::UnionType:
-			s = "UnionType";
-			break;
+			return "UnionType";
 		case TokenType::FunctionTypePredicate:
-			s = "FunctionTypePredicate";
-			break;
+			return "FunctionTypePredicate";
 		case TokenType::Variable:
-			s = "Variable";
-			break;
+			return "Variable";
 		case TokenType::MapObject:
-			s = "MapObject";
-			break;
+			return "MapObject";
 		case TokenType::ParameterPack:
-			s = "ParameterPack";
-			break;
+			return "ParameterPack";
 		case TokenType::ObjectCallable:
-			s = "ObjectCallable";
-			break;
+			return "ObjectCallable";
 		case TokenType::Function:
-			s = "Function";
-			break;
+			return "Function";
 		case TokenType::Constructor:
-			s = "Constructor";
-			break;
+			return "Constructor";
 		case TokenType::Parameter:
-			s = "Parameter";
-			break;
+			return "Parameter";
 		case TokenType::Property:
-			s = "Property";
-			break;
+			return "Property";
 		case TokenType::GenericParameter:
-			s = "GenericParameter";
-			break;
+			return "GenericParameter";
 		case TokenType::GenericParameterPack:
-			s = "GenericParameterPack";
-			break;
+			return "GenericParameterPack";
 		case TokenType::ClassElement:
-			s = "ClassElement";
-			break;
+			return "ClassElement";
 		case TokenType::Class:
-			s = "Class";
-			break;
+			return "Class";
 		case TokenType::GlobalFunction:
-			s = "GlobalFunction";
-			break;
+			return "GlobalFunction";
 		case TokenType::GlobalVariable:
-			s = "GlobalVariable";
-			break;
+			return "GlobalVariable";
 		case TokenType::NamespaceElement:
-			s = "NamespaceElement";
-			break;
+			return "NamespaceElement";
 		case TokenType::Namespace:
-			s = "Namespace";
-			break;
+			return "Namespace";
 		case TokenType::Import:
-			s = "Import";
-			break;
+			return "Import";
 		case TokenType::Export:
-			s = "Export";
-			break;
+			return "Export";
 		case TokenType::FileElement:
-			s = "FileElement";
-			break;
+			return "FileElement";
 		case TokenType::File:
-			s = "File";
-			break;
+			return "File";
+		case TokenType::Error:
+			return "Error";
 		default:
-			s = std::to_string(static_cast<int>(t));
-			break;
+			return std::string_view();
 		}
+	}
+
+	std::ostream & operator<<(std::ostream & os, TokenType t)
+	{
+		std::string_view s = name(t);
 
+		if (s.empty())
+		{
+			return os << static_cast<int>(t);
+		}
 		return os << s;
 	}
 }
\ No newline at end of file
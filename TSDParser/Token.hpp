@@ -1,8 +1,11 @@
 #ifndef NOPE_DTS_PARSER_TOKEN_HPP_
 # define NOPE_DTS_PARSER_TOKEN_HPP_
 
+# include <cstddef>
+# include <cstdint>
+# include <iosfwd>
 # include <string_view>
-# include <vector>
+# include <type_traits>
 
 namespace nope::dts::parser
 {
@@ -90,13 +93,18 @@ namespace nope::dts::parser
 		Import,
 		Export,
 		FileElement,
-		File
+		File,
+		// Tokens skipped by the parser in recovery mode
+		Error
 	};
 
+	// Interned identifier, see Interner
+	using Symbol = std::uint32_t;
+
 	struct Token
 	{
 		Token() = default;
-		Token(TokenType t, std::string_view val = "");
+		Token(TokenType t, std::size_t offset = 0, std::size_t length = 0, Symbol symbol = 0);
 		Token(Token const &that) = default;
 		Token(Token &&that) = default;
 
@@ -112,29 +120,27 @@ namespace nope::dts::parser
 
 		bool operator<(Token const &that) const;
 
-		TokenType type;
-		std::string_view value;
-		std::vector<Token> child;
-
-		Token &operator<<(Token &&children);
-
-		Token const &operator[](std::size_t i) const;
-		Token &operator[](std::size_t i);
-
-		std::size_t size() const;
+		bool sameText(Token const &that, std::string_view source, std::string_view thatSource) const;
 
-		Token const &last() const;
-		Token &last();
+		TokenType type;
+		std::uint32_t offset;
+		std::uint32_t length;
+		// Identifiers and keywords only, 0 for the other tokens
+		Symbol symbol;
 
 		bool isKeyword() const;
 		bool isReserved() const;
-
-		std::string json() const;
-		std::string code() const;
-		std::string xml() const;
 	};
 
+	static_assert(std::is_trivially_copyable_v<Token>,
+		"Tokens are copied around by the lookahead and must stay cheap");
+
+	bool isTerminal(TokenType type);
+	bool isKeyword(TokenType type);
+	bool isReserved(TokenType type);
+
 	bool operator<(TokenType l, TokenType r);
+	std::string_view name(TokenType t);
 	std::ostream &operator<<(std::ostream &os, TokenType t);
 }
 
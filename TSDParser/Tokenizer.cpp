@@ -1,64 +1,65 @@
 #include "stdafx.h"
-#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 namespace nope::dts::parser
 {
+	namespace
+	{
+		TokenType closing(TokenType open)
+		{
+			switch (open)
+			{
+			case TokenType::P_OPEN_PAR:
+				return TokenType::P_CLOSE_PAR;
+			case TokenType::P_OPEN_BRACE:
+				return TokenType::P_CLOSE_BRACE;
+			case TokenType::P_OPEN_BRACKET:
+				return TokenType::P_CLOSE_BRACKET;
+			default:
+				return TokenType::UNKNOWN;
+			}
+		}
+	}
+
 	/// <summary>
 	/// Initializes a new instance of the <see cref="Tokenizer"/> class.
 	/// </summary>
 	/// <param name="filename">The filename.</param>
 	Tokenizer::Tokenizer(std::string_view filename) :
-		m_filename(filename),
-		// m_input((std::istreambuf_iterator<char>(std::ifstream(m_filename))),
-		// 	std::istreambuf_iterator<char>()),
-		m_token(),
-		m_cursor(0)
-	{
-		std::ifstream file_stream(m_filename);  // Create the ifstream variable
-if (!file_stream) {
-    throw std::runtime_error("Failed to open file: " + m_filename);
-}
-this->m_input = (std::istreambuf_iterator<char>(), std::istreambuf_iterator<char>(file_stream)); // Use it here
-
-		for (std::size_t cursor = 0; cursor < m_input.size();)
-		{
-			Token token;
-			char cur = m_input[cursor];
-			char peek = m_input[cursor + 1];
-
-			if (std::isspace(cur))
-			{
-				token = this->parseSpace(cursor);
-			}
-			else if (cur == '/' && peek == '/')
-			{
-				token = this->parseLineComment(cursor);
-			}
-			else if (cur == '/' && peek == '*')
-			{
-				token = this->parseBlockComment(cursor);
-			}
-			else if (std::isalpha(cur) || cur == '_' || cur == '$')
-			{
-				token = this->parseId(cursor);
-				this->filterKeyword(token);
-			}
-			else if (cur == '"' || cur == '\'')
-			{
-				token = this->parseString(cursor);
-			}
-			else if (std::isdigit(cur))
-			{
-				token = this->parseNumber(cursor);
-			}
-			else
-			{
-				token = this->parsePunctuation(cursor);
-			}
+		Tokenizer(Source(filename))
+	{
+	}
 
-			m_token.push_back(token);
-		}
-		m_token.emplace_back(TokenType::END_OF_FILE);
+	/// <summary>
+	/// Initializes a new instance of the <see cref="Tokenizer"/> class.
+	/// </summary>
+	/// <param name="source">The input, whose text must outlive the tokenizer if it is borrowed.</param>
+	/// <param name="mode">Whether to keep the blanks and comments.</param>
+	Tokenizer::Tokenizer(Source source, TriviaMode mode) :
+		m_source(Source::borrow("")),
+		m_input(),
+		m_mode(mode),
+		m_window(initialWindow),
+		m_head(0),
+		m_count(0),
+		m_lexed(0),
+		m_done(false),
+		m_lines(),
+		m_index(0),
+		m_trivia(),
+		m_open(),
+		m_diagnostics(),
+		m_interner(&Interner::shared()),
+		m_symbols(),
+		m_failed(false),
+		m_recovery(false),
+		m_end(TokenType::END_OF_FILE),
+		m_last(TokenType::UNKNOWN),
+		m_started(false)
+	{
+		this->reset(std::move(source), mode);
 	}
 
 	/// <summary>
@@ -70,85 +71,185 @@ this->m_input = (std::istreambuf_iterator<char>(), std::istreambuf_iterator<char
 	}
 
 	/// <summary>
-	/// Peeks a token at the specified lookahead.
+	/// Start over on another input, keeping the memory of the previous one so
+	/// that a tokenizer reused over many files stops allocating once warmed up.
+	/// Nothing is lexed until the first lookup.
 	/// </summary>
-	/// <param name="lookAhead">Lookahead.</param>
-	/// <returns>The token found at this lookahead.</returns>
-	Token Tokenizer::peek(std::uint32_t lookAhead, bool ignoreNewline)
+	/// <param name="source">The input, whose text must outlive the tokenizer if it is borrowed.</param>
+	/// <param name="mode">Whether to keep the blanks and comments.</param>
+	void Tokenizer::reset(Source source, TriviaMode mode)
 	{
-		if (this->eof())
+		if (source.size() > std::numeric_limits<std::uint32_t>::max())
 		{
-			return m_token.back();
+			throw std::runtime_error("File too large: " + source.name());
 		}
 
-		std::size_t cursor = m_cursor;
-		TokenType type = m_token[cursor].type;
+		m_source = std::move(source);
+		m_input = m_source.data();
+		m_mode = mode;
+		m_head = 0;
+		m_count = 0;
+		m_lexed = 0;
+		m_done = false;
+		m_lines.clear();
+		m_lines.push_back(0);
+		m_index = 0;
+		m_trivia.clear();
+		m_diagnostics.clear();
+		m_failed = false;
+		m_end = Token(TokenType::END_OF_FILE, m_input.size(), 0);
+		m_last = Token(TokenType::UNKNOWN);
+		m_started = false;
+	}
+
+	/// <summary>
+	/// Restart the lexing at <paramref name="offset"/>, which must be the
+	/// start of a token, in order to parse again a part of the input.
+	/// The trivia table is left as is, the errors from offset on are dropped.
+	/// </summary>
+	void Tokenizer::seek(std::size_t offset)
+	{
+		m_diagnostics.erase(std::lower_bound(m_diagnostics.begin(), m_diagnostics.end(), offset,
+			[](Diagnostic const &d, std::size_t at) { return d.offset < at; }), m_diagnostics.end());
+		m_failed = false;
+		m_head = 0;
+		m_count = 0;
+		m_lexed = std::min(offset, m_input.size());
+		m_done = false;
+		m_last = Token(TokenType::UNKNOWN);
+		m_started = false;
+
+		// The line table must cover exactly what is before the new lexing position
+		m_lines.erase(std::upper_bound(m_lines.begin(), m_lines.end(), m_lexed), m_lines.end());
+		for (std::size_t nl = scan::findNewline(m_input.data(), m_lines.back(), m_lexed); nl < m_lexed;
+			nl = scan::findNewline(m_input.data(), nl + 1, m_lexed))
+		{
+			m_lines.push_back(static_cast<std::uint32_t>(nl + 1));
+		}
+	}
 
-		while (type != TokenType::END_OF_FILE)
+	/// <summary>
+	/// Peeks a token at the specified lookahead.
+	/// Comments and blanks are never returned.
+	/// </summary>
+	/// <param name="lookAhead">Lookahead.</param>
+	/// <param name="ignoreNewline">Whether newlines are skipped as well.</param>
+	/// <returns>
+	/// The token found at this lookahead, in the window: valid until the next lookup,
+	/// as a deeper peek() or peekAfterGroup() may grow the window and move it.
+	/// </returns>
+	Token const &Tokenizer::peek(std::uint32_t lookAhead, bool ignoreNewline) const
+	{
+		if (m_failed)
+		{
+			return m_end;
+		}
+		for (std::size_t i = 0;; ++i)
 		{
-			if (type == TokenType::LINE_COMMENT || type == TokenType::BLOCK_COMMENT ||
-				(type == TokenType::P_NEWLINE && ignoreNewline) || --lookAhead != 0)
+			Token const &token = this->at(i);
+
+			if (token.type == TokenType::END_OF_FILE)
 			{
-				++cursor;
+				return token;
 			}
-			else
+			if (ignoreNewline && token.type == TokenType::P_NEWLINE)
 			{
-				break;
+				continue;
+			}
+			if (lookAhead-- == 0)
+			{
+				return token;
 			}
 		}
-
-		return m_token[cursor];
 	}
 
 	/// <summary>
 	/// Get the next token
 	/// </summary>
-	/// <returns>Next token in the input</returns>
-	Token Tokenizer::next(bool ignoreNewline)
+	/// <param name="ignoreNewline">Whether newlines are skipped as well.</param>
+	/// <returns>Next token in the input, a copy kept out of the window: valid until the next call to next().</returns>
+	Token const &Tokenizer::next(bool ignoreNewline)
 	{
-		if (this->eof())
+		if (m_failed)
 		{
-			return m_token.back();
+			return m_end;
 		}
-
-		TokenType type = m_token[m_cursor].type;
-
-		while (type != TokenType::END_OF_FILE)
+		for (;;)
 		{
-			if (type == TokenType::LINE_COMMENT || type == TokenType::BLOCK_COMMENT ||
-				(type == TokenType::P_NEWLINE && ignoreNewline))
+			m_last = this->at(0);
+			m_started = true;
+
+			// Stay on the end of file token once reached
+			if (m_last.type == TokenType::END_OF_FILE)
 			{
-				++m_cursor;
+				return m_last;
 			}
-			else
+			m_head = (m_head + 1) & (m_window.size() - 1);
+			--m_count;
+
+			if (!ignoreNewline || m_last.type != TokenType::P_NEWLINE)
 			{
-				break;
+				return m_last;
 			}
 		}
-
-		return m_token[m_cursor++];
 	}
 
-	bool Tokenizer::nextIf(Token & token, TokenType type, std::uint32_t lookAhead, bool ignoreNewline)
+	/// <summary>
+	/// Peeks the token that follows the bracket group opened by the next token.
+	/// Newlines are skipped. The window grows to hold the whole group.
+	/// </summary>
+	/// <returns>
+	/// The token after the matching closing bracket, or nullptr if the group is never closed.
+	/// Like with peek(), it is only valid until the next lookup.
+	/// </returns>
+	Token const *Tokenizer::peekAfterGroup() const
 	{
-		if (this->peek(lookAhead, ignoreNewline).type == type)
+		std::size_t i = 0;
+
+		if (m_failed)
 		{
-			token << this->next(ignoreNewline);
-			return true;
+			return nullptr;
 		}
-		return false;
-	}
-
-	bool Tokenizer::nextIf(Token & token, std::function<bool()> func)
-	{
-		bool res = func();
+		while (this->at(i).type == TokenType::P_NEWLINE)
+		{
+			++i;
+		}
+		m_open.clear();
+		m_open.push_back(closing(this->at(i).type));
 
-		if (res)
+		while (!m_open.empty())
 		{
-			token << this->next();
+			TokenType type = this->at(++i).type;
+
+			switch (type)
+			{
+			case TokenType::END_OF_FILE:
+				return nullptr;
+			case TokenType::P_OPEN_PAR:
+			case TokenType::P_OPEN_BRACE:
+			case TokenType::P_OPEN_BRACKET:
+				m_open.push_back(closing(type));
+				break;
+			case TokenType::P_CLOSE_PAR:
+			case TokenType::P_CLOSE_BRACE:
+			case TokenType::P_CLOSE_BRACKET:
+				// A stray closing bracket is left unmatched rather than closing another kind of group
+				if (m_open.back() == type)
+				{
+					m_open.pop_back();
+				}
+				break;
+			default:
+				break;
+			}
 		}
 
-		return res;
+		do
+		{
+			++i;
+		} while (this->at(i).type == TokenType::P_NEWLINE);
+
+		return &this->at(i);
 	}
 
 	/// <summary>
@@ -157,26 +258,180 @@ this->m_input = (std::istreambuf_iterator<char>(), std::istreambuf_iterator<char
 	/// <returns></returns>
 	bool Tokenizer::eof() const
 	{
-		return m_cursor <= m_token.size();
+		return this->peek(0, true).type == TokenType::END_OF_FILE;
+	}
+
+	/// <summary>
+	/// Get the text of a token.
+	/// </summary>
+	std::string_view Tokenizer::value(Token const & token) const
+	{
+		return m_input.substr(token.offset, token.length);
+	}
+
+	/// <summary>
+	/// Get the whole input the tokens refer to.
+	/// </summary>
+	std::string_view Tokenizer::source() const
+	{
+		return m_input;
+	}
+
+	std::string const &Tokenizer::name() const
+	{
+		return m_source.name();
+	}
+
+	TriviaMode Tokenizer::mode() const
+	{
+		return m_mode;
+	}
+
+	/// <summary>
+	/// Get the offset right after the last token returned by next(), 0 if none was.
+	/// </summary>
+	std::size_t Tokenizer::consumed() const
+	{
+		return m_started ? m_last.offset + m_last.length : 0;
+	}
+
+	/// <summary>
+	/// Get the blanks and comments kept in TriviaMode::FULL.
+	/// The table is only complete once the end of file was reached.
+	/// </summary>
+	TriviaTable const &Tokenizer::trivia() const
+	{
+		return m_trivia;
+	}
+
+	/// <summary>
+	/// Enable or disable the recovery mode, kept across resets: the lexer
+	/// goes on after the errors it can recover from, recording them without
+	/// failing, and the parser resumes after the others.
+	/// </summary>
+	void Tokenizer::setRecovery(bool enabled)
+	{
+		m_recovery = enabled;
+	}
+
+	bool Tokenizer::recovery() const
+	{
+		return m_recovery;
+	}
+
+	/// <summary>
+	/// Intern the names into <paramref name="interner"/> instead of the shared
+	/// one, kept across resets. It must outlive the tokens read with it.
+	/// </summary>
+	void Tokenizer::setInterner(Interner &interner)
+	{
+		m_interner = &interner;
+	}
+
+	/// <summary>
+	/// Get the errors recorded since the last reset, sorted by offset: at
+	/// most one unless in recovery mode.
+	/// </summary>
+	std::vector<Diagnostic> const &Tokenizer::diagnostics() const
+	{
+		return m_diagnostics;
+	}
+
+	/// <summary>
+	/// Check whether an error occurred that the parser did not resume from.
+	/// </summary>
+	bool Tokenizer::failed() const
+	{
+		return m_failed;
+	}
+
+	/// <summary>
+	/// Go on reading the input after an error, the diagnostic being kept.
+	/// </summary>
+	void Tokenizer::resume()
+	{
+		m_failed = false;
 	}
 
 	/// <summary>
-	/// Throw an error with the specified message.
+	/// Record an error with the specified message and fail, unless failed already.
 	/// </summary>
 	/// <param name="message">The message.</param>
-	void Tokenizer::error(std::string_view message, std::size_t line, std::size_t col) const
+	/// <param name="offset">Where the error is in the input.</param>
+	void Tokenizer::error(std::string_view message, std::size_t offset) const
+	{
+		// Only the first error is meaningful, the next ones follow from it
+		if (m_failed)
+		{
+			return;
+		}
+		this->diagnose(message, offset);
+		m_failed = true;
+	}
+
+	/// <summary>
+	/// Record an error the lexer can go on after, failing only out of recovery mode.
+	/// </summary>
+	void Tokenizer::report(std::string_view message, std::size_t offset) const
+	{
+		if (m_recovery)
+		{
+			this->diagnose(message, offset);
+		}
+		else
+		{
+			this->error(message, offset);
+		}
+	}
+
+	/// <summary>
+	/// Record the diagnostic of an error.
+	/// </summary>
+	void Tokenizer::diagnose(std::string_view message, std::size_t offset) const
 	{
-		std::string location = m_filename + ':' + std::to_string(line)
-			+ ':' + std::to_string(col);
+		auto[line, col] = this->position(offset);
+		Diagnostic diagnostic{ m_source.name(), static_cast<std::uint32_t>(offset), line, col, std::string(message) };
 
-		throw error::Syntax(location + " Error: " + std::string(message));
+		// The lexer runs ahead of the parser, keep them in order
+		auto it = std::upper_bound(m_diagnostics.begin(), m_diagnostics.end(), diagnostic.offset,
+			[](std::uint32_t at, Diagnostic const &d) { return at < d.offset; });
+
+		// An error cascading up to the enclosing elements is only reported once
+		if (it == m_diagnostics.begin() || (it - 1)->offset != diagnostic.offset)
+		{
+			m_diagnostics.insert(it, std::move(diagnostic));
+		}
 	}
 
+	/// <summary>
+	/// Record an error located on the last token returned by next(), or on the
+	/// upcoming one if nothing was read yet.
+	/// </summary>
 	void Tokenizer::error(std::string_view message) const
 	{
-		auto[line, col] = this->getCursorPosition(m_cursor);
+		this->error(message, m_started ? m_last : this->peek(0, false));
+	}
+
+	/// <summary>
+	/// Record an error located on <paramref name="token"/>.
+	/// </summary>
+	void Tokenizer::error(std::string_view message, Token const & token) const
+	{
+		this->error(message, token.offset);
+	}
+
+	/// <summary>
+	/// Get the line and column, both starting at 1, of a byte offset in the input.
+	/// Columns are counted in bytes.
+	/// </summary>
+	/// <param name="offset">The byte offset.</param>
+	std::pair<std::size_t, std::size_t> Tokenizer::position(std::size_t offset) const
+	{
+		// m_lines[0] is always 0, so there is at least one line start at or before offset
+		auto it = std::upper_bound(m_lines.begin(), m_lines.end(), offset);
+		std::size_t line = static_cast<std::size_t>(it - m_lines.begin());
 
-		this->error(message, line, col);
+		return std::make_pair(line, offset - m_lines[line - 1] + 1);
 	}
 
 	bool Tokenizer::_eof(std::size_t cursor) const
@@ -194,228 +449,269 @@ this->m_input = (std::istreambuf_iterator<char>(), std::istreambuf_iterator<char
 		return m_input.size() - cursor;
 	}
 
-	Token Tokenizer::parseSpace(std::size_t &cursor)
+	/// <summary>
+	/// Get the <paramref name="index"/>-th token not read yet, newlines
+	/// included, lexing up to it if needed. Past the end, the end of file token.
+	/// </summary>
+	Token const &Tokenizer::at(std::size_t index) const
 	{
-		std::size_t begin = cursor;
+		while (m_count <= index && !m_done)
+		{
+			this->fill();
+		}
+		index = std::min(index, m_count - 1);
+		return m_window[(m_head + index) & (m_window.size() - 1)];
+	}
 
-		if (m_input[cursor] == '\n')
+	/// <summary>
+	/// Lex up to the next token the parser can see, and append it to the window.
+	/// </summary>
+	void Tokenizer::fill() const
+	{
+		while (!this->_eof(m_lexed))
 		{
-			++cursor;
-			return Token(TokenType::P_NEWLINE, std::string_view(&m_input[begin], 1));
+			Token token = this->lex(m_lexed);
+
+			if (token.type == TokenType::BLANK || token.type == TokenType::LINE_COMMENT ||
+				token.type == TokenType::BLOCK_COMMENT)
+			{
+				if (m_mode == TriviaMode::FULL)
+				{
+					m_trivia.push(token);
+				}
+				continue;
+			}
+			if (m_mode == TriviaMode::FULL)
+			{
+				// Newlines are read by the parser and kept as trivia as well,
+				// so that the trivia before a token holds all the text since the previous one
+				if (token.type == TokenType::P_NEWLINE)
+				{
+					m_trivia.push(token);
+				}
+				else
+				{
+					m_trivia.anchor(m_index++, token.offset);
+				}
+			}
+			this->push(token);
+			return;
+		}
+		if (m_mode == TriviaMode::FULL)
+		{
+			m_trivia.anchor(m_index, static_cast<std::uint32_t>(m_input.size()));
 		}
+		this->push(Token(TokenType::END_OF_FILE, m_input.size()));
+		m_done = true;
+	}
 
-		while (!this->_eof(cursor) &&
-			std::isspace(m_input[cursor]) && m_input[cursor] != '\n')
+	void Tokenizer::push(Token const & token) const
+	{
+		// Double the ring when full, unrolling it at the front of the new one
+		if (m_count == m_window.size())
 		{
-			++cursor;
+			std::vector<Token> window(m_window.size() * 2);
+
+			for (std::size_t i = 0; i < m_count; ++i)
+			{
+				window[i] = m_window[(m_head + i) & (m_window.size() - 1)];
+			}
+			m_window.swap(window);
+			m_head = 0;
 		}
+		m_window[(m_head + m_count++) & (m_window.size() - 1)] = token;
+	}
+
+	/// <summary>
+	/// Lex the token starting at <paramref name="cursor"/>, moving it past the token.
+	/// </summary>
+	Token Tokenizer::lex(std::size_t &cursor) const
+	{
+		Token token;
+		char cur = m_input[cursor];
+		char peek = cursor + 1 < m_input.size() ? m_input[cursor + 1] : '\0';
 
-		return Token(TokenType::BLANK, std::string_view(&m_input[begin], cursor - begin));
+		switch (charset::classOf(cur))
+		{
+		case charset::CharClass::SPACE:
+		case charset::CharClass::NEWLINE:
+			return this->parseSpace(cursor);
+		case charset::CharClass::SLASH:
+			if (peek == '/')
+			{
+				return this->parseLineComment(cursor);
+			}
+			if (peek == '*')
+			{
+				return this->parseBlockComment(cursor);
+			}
+			return this->parsePunctuation(cursor);
+		case charset::CharClass::ID_START:
+			token = this->parseId(cursor);
+			this->filterKeyword(token);
+			return token;
+		case charset::CharClass::QUOTE:
+			return this->parseString(cursor);
+		case charset::CharClass::DIGIT:
+			return this->parseNumber(cursor);
+		case charset::CharClass::PUNCTUATION:
+			return this->parsePunctuation(cursor);
+		default:
+			return this->parseUnknown(cursor);
+		}
 	}
 
-	Token Tokenizer::parseLineComment(std::size_t &cursor)
+	Token Tokenizer::parseSpace(std::size_t &cursor) const
 	{
 		std::size_t begin = cursor;
 
-		while (!this->_eof(cursor) && m_input[cursor] != '\n')
+		if (m_input[cursor] == '\n')
+		{
 			++cursor;
+			m_lines.push_back(static_cast<std::uint32_t>(cursor));
+			return Token(TokenType::P_NEWLINE, begin, 1);
+		}
+
+		cursor = scan::skipSpace(m_input.data(), cursor, m_input.size());
 
-		return Token(TokenType::LINE_COMMENT, std::string_view(&m_input[begin], cursor - begin));
+		return Token(TokenType::BLANK, begin, cursor - begin);
 	}
 
-	Token Tokenizer::parseBlockComment(std::size_t &cursor)
+	Token Tokenizer::parseLineComment(std::size_t &cursor) const
 	{
 		std::size_t begin = cursor;
 
-		while (cursor - begin < 4 || m_input[cursor - 1] != '/' || m_input[cursor - 2] != '*')
+		cursor = scan::findNewline(m_input.data(), cursor, m_input.size());
+
+		return Token(TokenType::LINE_COMMENT, begin, cursor - begin);
+	}
+
+	Token Tokenizer::parseBlockComment(std::size_t &cursor) const
+	{
+		std::size_t begin = cursor;
+
+		// Skip the opening "/*" so that "/*/" does not close itself
+		cursor = scan::findCommentEnd(m_input.data(), cursor + 2, m_input.size());
+
+		if (this->_eof(cursor))
 		{
-			if (this->_eof(cursor))
-			{
-				auto [line, col] = this->getCursorPosition(m_token.size());
+			// In recovery mode the comment runs to the end of file
+			this->report("Dit you forgot to close the block comment ?", begin);
+		}
+		cursor = std::min(cursor + 2, m_input.size());
 
-				this->error("Dit you forgot to close the block comment ?", line, col);
-			}
-			++cursor;
+		for (std::size_t nl = scan::findNewline(m_input.data(), begin, cursor); nl < cursor;
+			nl = scan::findNewline(m_input.data(), nl + 1, cursor))
+		{
+			m_lines.push_back(static_cast<std::uint32_t>(nl + 1));
 		}
 
-		return Token(TokenType::BLOCK_COMMENT, std::string_view(&m_input[begin], cursor - begin));
+		return Token(TokenType::BLOCK_COMMENT, begin, cursor - begin);
 	}
 
-	Token Tokenizer::parseId(std::size_t &cursor)
+	Token Tokenizer::parseId(std::size_t &cursor) const
 	{
 		std::size_t begin = cursor;
 
-		while (!this->_eof(cursor) &&
-				(std::isalnum(m_input[cursor]) ||
-				m_input[cursor] == '_' ||
-				m_input[cursor] == '$'))
-		{
-			++cursor;
-		}
+		cursor = scan::skipIdentifier(m_input.data(), cursor, m_input.size());
 
-		return Token(TokenType::ID, std::string_view(&m_input[begin], cursor - begin));
+		return Token(TokenType::ID, begin, cursor - begin);
 	}
 
 	void Tokenizer::filterKeyword(Token & token) const
 	{
-		std::pair<const char *, TokenType> val[] = {
-			{ "class", TokenType::KW_CLASS },
-			{ "interface", TokenType::KW_INTERFACE },
-			{ "constructor", TokenType::KW_CONSTRUCTOR },
-			{ "const", TokenType::KW_CONST },
-			{ "enum", TokenType::KW_ENUM },
-			{ "export", TokenType::KW_EXPORT },
-			{ "extends", TokenType::KW_EXTENDS },
-			{ "function", TokenType::KW_FUNCTION },
-			{ "import", TokenType::KW_IMPORT },
-			{ "in", TokenType::KW_IN },
-			{ "typeof", TokenType::KW_TYPEOF },
-			{ "type", TokenType::KW_TYPE },
-			{ "keyof", TokenType::KW_KEYOF },
-			{ "var", TokenType::KW_VAR },
-			{ "let", TokenType::KW_VAR },
-			{ "implements", TokenType::KW_IMPLEMENTS },
-			{ "private", TokenType::KW_VISIBILITY },
-			{ "protected", TokenType::KW_VISIBILITY },
-			{ "public", TokenType::KW_VISIBILITY },
-			{ "static", TokenType::KW_STATIC },
-			{ "readonly", TokenType::KW_READONLY },
-			{ "as", TokenType::KW_AS },
-			{ "is", TokenType::KW_IS },
-			{ "from", TokenType::KW_FROM },
-			{ "declare", TokenType::KW_DECLARE },
-			{ "module", TokenType::KW_MODULE },
-			{ "namespace", TokenType::KW_MODULE },
-			{ "require", TokenType::KW_REQUIRE }
-		};
-
-		for (auto const &v : val)
+		std::string_view id = this->value(token);
+		std::size_t k = keyword::find(id);
+
+		if (k != keyword::count)
 		{
-			if (token.value == v.first)
-			{
-				token.type = v.second;
-				return ;
-			}
+			token.type = keyword::list[k].type;
+			token.symbol = Interner::keyword(k);
+		}
+		else
+		{
+			token.symbol = m_interner->intern(id, m_symbols);
 		}
 	}
 
-	Token Tokenizer::parseString(std::size_t &cursor)
+	Token Tokenizer::parseString(std::size_t &cursor) const
 	{
 		char quote = m_input[cursor];
 		std::size_t begin = cursor++;
 
-		bool esc = false;
-
 		while (!this->_eof(cursor))
 		{
-			if (!esc && m_input[cursor] == quote)
+			cursor = scan::findStringStop(m_input.data(), cursor, m_input.size(), quote);
+
+			if (this->_eof(cursor))
 			{
-				cursor++;
 				break;
 			}
-			if (!esc && m_input[cursor] == '\n')
+			if (m_input[cursor] == quote)
 			{
-				this->error("Unexpected newline");
+				cursor++;
+				break;
 			}
-			if (!esc && m_input[cursor] == '\\')
+			if (m_input[cursor] == '\n')
 			{
-				esc = true;
+				// In recovery mode the string ends with the line
+				this->report("Unexpected newline", cursor);
+				break;
 			}
-			else
+			// Backslash: the escaped character can not end the string
+			if (cursor + 1 < m_input.size() && m_input[cursor + 1] == '\n')
 			{
-				esc = false;
+				m_lines.push_back(static_cast<std::uint32_t>(cursor + 2));
 			}
-			++cursor;
+			cursor = std::min(cursor + 2, m_input.size());
 		}
 
-		return Token(TokenType::STRING_LITERAL, std::string_view(&m_input[begin], cursor - begin));
+		return Token(TokenType::STRING_LITERAL, begin, cursor - begin);
 	}
 
-	Token Tokenizer::parseNumber(std::size_t &cursor)
+	Token Tokenizer::parseNumber(std::size_t &cursor) const
 	{
 		std::size_t begin = cursor;
 
-		while (!this->_eof(cursor) && std::isdigit(m_input[cursor]))
+		while (!this->_eof(cursor) && charset::isDigit(m_input[cursor]))
 		{
 			++cursor;
 		}
 
-		return Token(TokenType::NUMBER, std::string_view(&m_input[begin], cursor - begin));
+		return Token(TokenType::NUMBER, begin, cursor - begin);
 	}
 
-	Token Tokenizer::parsePunctuation(std::size_t &cursor)
+	Token Tokenizer::parsePunctuation(std::size_t &cursor) const
 	{
 		std::size_t begin = cursor;
+		char cur = m_input[cursor];
 
-		std::pair<const char *, TokenType> val[] = {
-			{ "=>", TokenType::P_ARROW },				// Keep the arrow before the equal token
-			{ "...", TokenType::P_SPREAD },
-			{ ":", TokenType::P_COLON },
-			{ ";", TokenType::P_SEMICOLON },
-			{ "\n", TokenType::P_NEWLINE },
-			{ ".", TokenType::P_DOT },
-			{ ",", TokenType::P_COMMA },
-			{ "/", TokenType::P_SLASH },
-			{ "\\", TokenType::P_ANTISLASH },
-			{ "?", TokenType::P_QUESTION },
-			{ "*", TokenType::P_STAR },
-			{ "(", TokenType::P_OPEN_PAR },
-			{ ")", TokenType::P_CLOSE_PAR },
-			{ "{", TokenType::P_OPEN_BRACE },
-			{ "}", TokenType::P_CLOSE_BRACE },
-			{ "[", TokenType::P_OPEN_BRACKET },
-			{ "]", TokenType::P_CLOSE_BRACKET },
-			{ "=", TokenType::P_EQUAL },
-			{ "|", TokenType::P_VERTICAL_BAR },
-			{ "<", TokenType::P_GREATER_THAN },
-			{ ">", TokenType::P_LESS_THAN },
-			{ "&", TokenType::P_AMPERSAND }
-		};
-
-		for (auto const &v : val)
+		// The only multi-character punctuations are '=>' and '...'
+		if (cur == '=' && this->remain(cursor) >= 2 && m_input[cursor + 1] == '>')
 		{
-			if (std::size_t len = strlen(v.first); m_input.substr(begin, len) == v.first)
-			{
-				cursor += len;
-				return Token(v.second, std::string_view(&m_input[begin], len));
-			}
+			cursor += 2;
+			return Token(TokenType::P_ARROW, begin, 2);
+		}
+		if (cur == '.' && this->remain(cursor) >= 3 && m_input[cursor + 1] == '.' && m_input[cursor + 2] == '.')
+		{
+			cursor += 3;
+			return Token(TokenType::P_SPREAD, begin, 3);
 		}
-		return Token(TokenType::UNKNOWN);
+
+		++cursor;
+		return Token(charset::punctuation[static_cast<unsigned char>(cur)], begin, 1);
 	}
 
-	std::pair<std::size_t, std::size_t> Tokenizer::getCursorPosition(std::size_t index) const
+	/// <summary>
+	/// Make an UNKNOWN token out of a character the language does not use.
+	/// A whole UTF-8 sequence is consumed so the token never splits a character.
+	/// </summary>
+	Token Tokenizer::parseUnknown(std::size_t &cursor) const
 	{
-		std::size_t line = 1;
-		std::size_t col = 1;
-
-		for (std::size_t i = 0; i < index; ++i)
-		{
-			if (m_token[i].type == TokenType::P_NEWLINE)
-			{
-				++line;
-				col = 1;
-			}
-			else if (m_token[i].type == TokenType::BLOCK_COMMENT)
-			{
-				for (std::size_t j = 0; j < m_token[i].value.size(); ++j)
-				{
-					if (m_token[i].value[j] == '\n')
-					{
-						++line;
-						col = 1;
-					}
-					else
-					{
-						++col;
-					}
-				}
-			}
-			else
-			{
-				++col;
-			}
-		}
+		std::size_t begin = cursor;
+		std::size_t len = std::min(charset::sequenceLength(m_input[cursor]), this->remain(cursor));
 
-		return std::make_pair(line, col);
+		cursor += len;
+		return Token(TokenType::UNKNOWN, begin, len);
 	}
 }
@@ -1,19 +1,34 @@
 #ifndef NOPE_DTS_PARSER_TOKENIZER_HPP_
 # define NOPE_DTS_PARSER_TOKENIZER_HPP_
 
-# include <functional>
 # include <string_view>
 # include <cinttypes>
+# include <vector>
 # include "Token.hpp"
-# include <string>
+# include "Source.hpp"
+# include "Trivia.hpp"
+# include "Diagnostic.hpp"
+# include "Interner.hpp"
 
 namespace nope::dts::parser
 {
+	/// <summary>
+	/// Pull-mode lexer: tokens are lexed as the parser looks at them and
+	/// dropped once read, so only a small window of upcoming tokens is ever
+	/// held in memory. Blanks and comments never reach the parser: they are
+	/// dropped at lex time, or in TriviaMode::FULL moved to a side table.
+	/// Identifiers and keywords are interned as they are lexed, in the
+	/// interner shared by the process.
+	/// Errors do not throw: the first one is recorded and the tokenizer is
+	/// failed from then on, reading as the end of file, so that the parser
+	/// winds down through its ordinary paths.
+	/// </summary>
 	class Tokenizer
 	{
 	public:
 		Tokenizer() = delete;
 		Tokenizer(std::string_view filename);
+		Tokenizer(Source source, TriviaMode mode = TriviaMode::FAST);
 		Tokenizer(Tokenizer const &that) = delete;
 		Tokenizer(Tokenizer &&that) = delete;
 		
@@ -22,35 +37,89 @@ namespace nope::dts::parser
 		Tokenizer &operator=(Tokenizer const &that) = delete;
 		Tokenizer &operator=(Tokenizer &&that) = delete;
 
-		Token peek(std::uint32_t lookAhead = 0, bool ignoreNewline = false);
-		Token next(bool ignoreNewline = false);
-		bool nextIf(Token &token, TokenType type, std::uint32_t lookAhead = 0, bool skipNewline = true);
-		bool nextIf(Token &token, std::function<bool()> func);
+		void reset(Source source, TriviaMode mode = TriviaMode::FAST);
+		void seek(std::size_t offset);
+
+		Token const &peek(std::uint32_t lookAhead = 0, bool ignoreNewline = true) const;
+		Token const &next(bool ignoreNewline = true);
+		Token const *peekAfterGroup() const;
 		bool eof() const;
 
-		void error(std::string_view message, std::size_t line, std::size_t col) const;
+		std::string_view value(Token const &token) const;
+
+		std::string_view source() const;
+		std::string const &name() const;
+		TriviaMode mode() const;
+		TriviaTable const &trivia() const;
+		std::size_t consumed() const;
+
+		void setRecovery(bool enabled);
+		bool recovery() const;
+		void setInterner(Interner &interner);
+		std::vector<Diagnostic> const &diagnostics() const;
+		bool failed() const;
+		void resume();
+
+		void error(std::string_view message, std::size_t offset) const;
 		void error(std::string_view message) const;
+		void error(std::string_view message, Token const &token) const;
+		void report(std::string_view message, std::size_t offset) const;
+
+		std::pair<std::size_t, std::size_t> position(std::size_t offset) const;
 	private:
+		// Must be a power of two, the ring index is masked
+		static constexpr std::size_t initialWindow = 64;
+
 		bool _eof(std::size_t cursor) const;
 		std::size_t remain(std::size_t cursor) const;
 
+		void diagnose(std::string_view message, std::size_t offset) const;
+
+		Token const &at(std::size_t index) const;
+		void fill() const;
+		void push(Token const &token) const;
+		Token lex(std::size_t &cursor) const;
+
 		// Parsing methods
-		Token parseSpace(std::size_t &cursor);
-		Token parseLineComment(std::size_t &cursor);
-		Token parseBlockComment(std::size_t &cursor);
-		Token parseId(std::size_t &cursor);
+		Token parseSpace(std::size_t &cursor) const;
+		Token parseLineComment(std::size_t &cursor) const;
+		Token parseBlockComment(std::size_t &cursor) const;
+		Token parseId(std::size_t &cursor) const;
 		void filterKeyword(Token &token) const;
-		Token parseString(std::size_t &cursor);
-		Token parseNumber(std::size_t &cursor);
-		Token parsePunctuation(std::size_t &cursor);
+		Token parseString(std::size_t &cursor) const;
+		Token parseNumber(std::size_t &cursor) const;
+		Token parsePunctuation(std::size_t &cursor) const;
+		Token parseUnknown(std::size_t &cursor) const;
 
-		std::pair<std::size_t, std::size_t> getCursorPosition(std::size_t index) const;
+		Source m_source;
+		std::string_view m_input;
+		TriviaMode m_mode;
 
-		std::string m_filename;
-		std::string m_input;
-		std::vector<Token> m_token;
+		// Filled on demand by the lookups, hence mutable.
+		// Ring of the tokens lexed but not read yet, newlines included
+		mutable std::vector<Token> m_window;
+		mutable std::size_t m_head;
+		mutable std::size_t m_count;
+		// Where the lexer stopped, and whether it pushed the end of file token
+		mutable std::size_t m_lexed;
+		mutable bool m_done;
+		mutable std::vector<std::uint32_t> m_lines;
+		// Index of the next token, newlines not counted, to key the trivia with
+		mutable std::uint32_t m_index;
+		mutable TriviaTable m_trivia;
+		// Scratch stack of the brackets to close, for peekAfterGroup
+		mutable std::vector<TokenType> m_open;
+		// Errors recorded in recovery mode, sorted by offset
+		mutable std::vector<Diagnostic> m_diagnostics;
+		Interner *m_interner;
+		mutable Interner::Cache m_symbols;
+		mutable bool m_failed;
+		bool m_recovery;
+		// Read in place of the input once failed
+		Token m_end;
 
-		std::size_t m_cursor;
+		Token m_last;
+		bool m_started;
 	};
 }
 
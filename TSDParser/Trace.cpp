@@ -0,0 +1,159 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+namespace nope::dts::parser::trace
+{
+	namespace
+	{
+		struct Ring
+		{
+			std::array<Event, capacity> events;
+			std::atomic<std::uint64_t> head{ 0 };
+			std::size_t thread = 0;
+		};
+
+		// Rings outlive their thread so they can still be dumped after a batch
+		std::mutex g_mutex;
+		std::vector<std::unique_ptr<Ring>> g_rings;
+
+		Ring &local()
+		{
+			thread_local Ring *ring = nullptr;
+
+			if (ring == nullptr)
+			{
+				std::lock_guard<std::mutex> lock(g_mutex);
+
+				g_rings.push_back(std::make_unique<Ring>());
+				ring = g_rings.back().get();
+				ring->thread = g_rings.size() - 1;
+			}
+			return *ring;
+		}
+
+		// Length of the first len bytes of a text, less a character cut in two at the end
+		std::size_t whole(char const *text, std::size_t len)
+		{
+			std::size_t lead = len;
+
+			while (lead > 0 && len - lead < 3 && (static_cast<unsigned char>(text[lead - 1]) & 0xC0) == 0x80)
+			{
+				--lead;
+			}
+			if (lead > 0)
+			{
+				unsigned char c = static_cast<unsigned char>(text[lead - 1]);
+				std::size_t size = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+
+				return lead - 1 + size > len ? lead - 1 : len;
+			}
+			return len;
+		}
+
+		void escape(std::ostream &os, std::string_view value)
+		{
+			for (char c : value)
+			{
+				switch (c)
+				{
+				case '"':
+					os << "\\\"";
+					break;
+				case '\\':
+					os << "\\\\";
+					break;
+				case '\n':
+					os << "\\n";
+					break;
+				case '\r':
+					os << "\\r";
+					break;
+				case '\t':
+					os << "\\t";
+					break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						os << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xF] << "0123456789abcdef"[c & 0xF];
+					}
+					else
+					{
+						os << c;
+					}
+					break;
+				}
+			}
+		}
+	}
+
+	/// <summary>
+	/// Turn the recording on or off at run time.
+	/// </summary>
+	void enable(bool enabled)
+	{
+		detail::active.store(enabled, std::memory_order_relaxed);
+	}
+
+	/// <summary>
+	/// Record that a <paramref name="child"/> node was attached to a <paramref name="parent"/> node.
+	/// Only the beginning of the value is kept, up to a character boundary.
+	/// </summary>
+	void node(TokenType parent, TokenType child, std::string_view value)
+	{
+		Ring &ring = local();
+		std::uint64_t sequence = ring.head.load(std::memory_order_relaxed);
+		Event &event = ring.events[sequence % capacity];
+		std::size_t len = value.size() > sizeof(event.text) ? whole(value.data(), sizeof(event.text)) : value.size();
+
+		event.sequence = sequence;
+		event.parent = parent;
+		event.child = child;
+		event.length = static_cast<std::uint32_t>(value.size());
+		event.kept = static_cast<std::uint8_t>(len);
+		std::memcpy(event.text, value.data(), len);
+		ring.head.store(sequence + 1, std::memory_order_release);
+	}
+
+	/// <summary>
+	/// Write every recorded event as JSON lines, thread by thread, oldest first.
+	/// Must be called while no thread is recording.
+	/// </summary>
+	void dump(std::ostream &os)
+	{
+		std::lock_guard<std::mutex> lock(g_mutex);
+
+		for (auto const &ring : g_rings)
+		{
+			std::uint64_t head = ring->head.load(std::memory_order_acquire);
+			std::uint64_t begin = head > capacity ? head - capacity : 0;
+
+			for (std::uint64_t i = begin; i < head; ++i)
+			{
+				Event const &event = ring->events[i % capacity];
+				os << "{\"thread\":" << ring->thread << ",\"seq\":" << event.sequence
+					<< ",\"parent\":\"" << event.parent << "\",\"child\":\"" << event.child
+					<< "\",\"value\":\"";
+				escape(os, std::string_view(event.text, event.kept));
+				os << "\",\"length\":" << event.length << "}\n";
+			}
+		}
+	}
+
+	/// <summary>
+	/// Drop every recorded event.
+	/// Must be called while no thread is recording.
+	/// </summary>
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock(g_mutex);
+
+		for (auto &ring : g_rings)
+		{
+			ring->head.store(0, std::memory_order_relaxed);
+		}
+	}
+}
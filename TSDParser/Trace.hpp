@@ -0,0 +1,58 @@
+#ifndef NOPE_DTS_PARSER_TRACE_HPP_
+# define NOPE_DTS_PARSER_TRACE_HPP_
+
+# include <atomic>
+# include <cstdint>
+# include <iosfwd>
+# include <string_view>
+# include "Token.hpp"
+
+/// <summary>
+/// Structured trace of the AST construction.
+/// The trace points are compiled in only when NOPE_DTS_TRACE is defined, and
+/// even then they cost a single relaxed load until trace::enable is called.
+/// Each thread records into its own fixed-size ring, so recording never
+/// locks nor allocates; the oldest events are overwritten when it is full.
+/// </summary>
+namespace nope::dts::parser::trace
+{
+	constexpr std::size_t capacity = 4096;
+
+	struct Event
+	{
+		std::uint64_t sequence;
+		TokenType parent;
+		TokenType child;
+		// Of the whole value, of which only the first kept bytes are in text
+		std::uint32_t length;
+		std::uint8_t kept;
+		char text[27];
+	};
+
+	namespace detail
+	{
+		inline std::atomic<bool> active{ false };
+	}
+
+	inline bool enabled()
+	{
+		return detail::active.load(std::memory_order_relaxed);
+	}
+
+	void enable(bool enabled);
+
+	void node(TokenType parent, TokenType child, std::string_view value);
+
+	void dump(std::ostream &os);
+	void clear();
+}
+
+# ifdef NOPE_DTS_TRACE
+#  define NOPE_DTS_TRACE_NODE(parent, child, value)							\
+	(::nope::dts::parser::trace::enabled() ?								\
+		::nope::dts::parser::trace::node((parent), (child), (value)) : (void)0)
+# else
+#  define NOPE_DTS_TRACE_NODE(parent, child, value) ((void)0)
+# endif
+
+#endif // !NOPE_DTS_PARSER_TRACE_HPP_
@@ -0,0 +1,101 @@
+#include "stdafx.h"
+#include <algorithm>
+
+namespace nope::dts::parser
+{
+	/// <summary>
+	/// Drop every trivia, keeping the memory.
+	/// </summary>
+	void TriviaTable::clear()
+	{
+		m_tokens.clear();
+		m_entries.clear();
+		m_pending = 0;
+	}
+
+	/// <summary>
+	/// Append a trivia token, in input order.
+	/// </summary>
+	void TriviaTable::push(Token const & trivia)
+	{
+		m_tokens.push_back(trivia);
+	}
+
+	/// <summary>
+	/// Attach the trivia pushed since the previous anchor to the token of the
+	/// given index and offset.
+	/// </summary>
+	void TriviaTable::anchor(std::uint32_t index, std::uint32_t offset)
+	{
+		if (m_pending != m_tokens.size())
+		{
+			m_entries.push_back({ index, offset, m_pending });
+			m_pending = static_cast<std::uint32_t>(m_tokens.size());
+		}
+	}
+
+	/// <summary>
+	/// Get the number of trivia tokens.
+	/// </summary>
+	std::size_t TriviaTable::size() const
+	{
+		return m_tokens.size();
+	}
+
+	/// <summary>
+	/// Get the trivia right before the token starting at <paramref name="anchor"/>.
+	/// </summary>
+	TriviaTable::Range TriviaTable::leading(std::uint32_t anchor) const
+	{
+		auto it = std::lower_bound(m_entries.begin(), m_entries.end(), anchor,
+			[](Entry const &e, std::uint32_t a) { return e.anchor < a; });
+
+		return it != m_entries.end() && it->anchor == anchor ? this->range(it) : Range{ nullptr, nullptr };
+	}
+
+	/// <summary>
+	/// Get the trivia right before the <paramref name="index"/>-th token, newlines not counted.
+	/// </summary>
+	TriviaTable::Range TriviaTable::leadingIndex(std::uint32_t index) const
+	{
+		auto it = std::lower_bound(m_entries.begin(), m_entries.end(), index,
+			[](Entry const &e, std::uint32_t i) { return e.index < i; });
+
+		return it != m_entries.end() && it->index == index ? this->range(it) : Range{ nullptr, nullptr };
+	}
+
+	/// <summary>
+	/// Get the documentation comment, /** ... */, of the declaration starting at <paramref name="anchor"/>.
+	/// Only blanks and newlines may stand between the comment and the declaration.
+	/// </summary>
+	/// <returns>The comment, or nullptr if the declaration is not documented.</returns>
+	Token const *TriviaTable::docComment(std::string_view source, std::uint32_t anchor) const
+	{
+		Range trivia = this->leading(anchor);
+
+		for (Token const *it = trivia.last; it != trivia.first; --it)
+		{
+			Token const &token = it[-1];
+
+			if (token.type == TokenType::BLOCK_COMMENT)
+			{
+				std::string_view text = source.substr(token.offset, token.length);
+
+				// "/**/" is an empty comment, not a documentation one
+				return text.size() > 4 && text.compare(0, 3, "/**") == 0 ? &token : nullptr;
+			}
+			if (token.type != TokenType::BLANK && token.type != TokenType::P_NEWLINE)
+			{
+				return nullptr;
+			}
+		}
+		return nullptr;
+	}
+
+	TriviaTable::Range TriviaTable::range(std::vector<Entry>::const_iterator it) const
+	{
+		std::uint32_t last = it + 1 != m_entries.end() ? (it + 1)->first : m_pending;
+
+		return Range{ m_tokens.data() + it->first, m_tokens.data() + last };
+	}
+}
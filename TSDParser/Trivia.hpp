@@ -0,0 +1,78 @@
+#ifndef NOPE_DTS_PARSER_TRIVIA_HPP_
+# define NOPE_DTS_PARSER_TRIVIA_HPP_
+
+# include <cstddef>
+# include <cstdint>
+# include <string_view>
+# include <vector>
+# include "Token.hpp"
+
+namespace nope::dts::parser
+{
+	enum class TriviaMode
+	{
+		// Blanks and comments are dropped as soon as they are lexed
+		FAST,
+		// They are kept in a TriviaTable, for documentation and exact round-tripping
+		FULL
+	};
+
+	/// <summary>
+	/// Blanks, comments and newlines of an input, stored apart from the
+	/// tokens the parser reads. Each run of trivia is keyed by the index of
+	/// the token it precedes, newlines not counted, and by that token's
+	/// offset, the anchor; the trivia after the last token is anchored on
+	/// the end of file.
+	/// </summary>
+	class TriviaTable
+	{
+	public:
+		struct Range
+		{
+			Token const *first;
+			Token const *last;
+
+			Token const *begin() const { return first; }
+			Token const *end() const { return last; }
+			bool empty() const { return first == last; }
+		};
+
+		TriviaTable() = default;
+		TriviaTable(TriviaTable const &that) = default;
+		TriviaTable(TriviaTable &&that) = default;
+
+		~TriviaTable() noexcept = default;
+
+		TriviaTable &operator=(TriviaTable const &that) = default;
+		TriviaTable &operator=(TriviaTable &&that) = default;
+
+		void clear();
+
+		void push(Token const &trivia);
+		void anchor(std::uint32_t index, std::uint32_t offset);
+
+		std::size_t size() const;
+
+		Range leading(std::uint32_t anchor) const;
+		Range leadingIndex(std::uint32_t index) const;
+
+		Token const *docComment(std::string_view source, std::uint32_t anchor) const;
+
+	private:
+		struct Entry
+		{
+			std::uint32_t index;
+			std::uint32_t anchor;
+			std::uint32_t first;
+		};
+
+		Range range(std::vector<Entry>::const_iterator it) const;
+
+		std::vector<Token> m_tokens;
+		std::vector<Entry> m_entries;
+		// First trivia token not anchored yet
+		std::uint32_t m_pending = 0;
+	};
+}
+
+#endif // !NOPE_DTS_PARSER_TRIVIA_HPP_
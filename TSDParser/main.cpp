@@ -1,30 +1,116 @@
 #include "stdafx.h"
+#include <cstdlib>
 #include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+# include <io.h>
+# include <fcntl.h>
+#endif
 
 // TODO: remove that ugly thing
 using namespace nope::dts::parser;
 
 int main(int ac, char **av)
 {
-	try
+	std::string traceFile;
+	Options options;
+	std::vector<std::string> files;
+	bool project = false;
+
+	for (int i = 1; i < ac; ++i)
 	{
-		for (int i = 1; i < ac; ++i)
-		{
-			Parser parser(av[i]);
+		std::string_view arg(av[i]);
 
-			parser.parse();
+		if (arg == "--trace" && i + 1 < ac)
+		{
+#ifdef NOPE_DTS_TRACE
+			// Dumped as JSON lines once every file is parsed
+			traceFile = av[++i];
+			trace::enable(true);
+#else
+			std::cerr << "Tracing is not compiled in this build, define NOPE_DTS_TRACE" << std::endl;
+			return 2;
+#endif
+		}
+		else if (arg == "--emit" && i + 1 < ac)
+		{
+			options.emit = av[++i];
+			if (options.emit != "json" && options.emit != "xml" && options.emit != "code" &&
+				options.emit != "binary")
+			{
+				std::cerr << "Unknown output format: " << options.emit << std::endl;
+				return 2;
+			}
+		}
+		else if (arg == "--compact")
+		{
+			options.compact = true;
+		}
+		else if (arg == "--recover")
+		{
+			options.recover = true;
+		}
+		else if (arg == "--project")
+		{
+			// The files are the roots, the output is their module graph
+			project = true;
+		}
+		else if (arg == "--cache" && i + 1 < ac)
+		{
+			options.cache = av[++i];
+		}
+		else if (arg == "--cache-size" && i + 1 < ac)
+		{
+			// In megabytes
+			options.cacheSize = std::strtoull(av[++i], nullptr, 10) * 1024 * 1024;
+		}
+		else if (arg == "-o" && i + 1 < ac)
+		{
+			options.output = av[++i];
+		}
+		else if (arg == "-j" && i + 1 < ac)
+		{
+			options.jobs = std::strtoul(av[++i], nullptr, 10);
+		}
+		else
+		{
+			files.emplace_back(arg);
+		}
+	}
 
-			std::cout << "OK" << std::flush;
+#ifdef _WIN32
+	// The binary format must not go through the newline translation
+	if (options.emit == "binary" && options.output == "-")
+	{
+		_setmode(_fileno(stdout), _O_BINARY);
+	}
+#endif
 
-			/*std::ofstream os("output.xml");
+	int status;
 
-			os << parser.ast().xml();*/
+	try
+	{
+		if (project)
+		{
+			status = Project(options).run(input::expand(files));
+		}
+		else
+		{
+			status = Driver(options).run(input::expand(files));
 		}
 	}
-	catch (nope::dts::parser::error::Syntax const &e)
+	catch (std::exception const &e)
 	{
 		std::cerr << e.what() << std::endl;
-		return 1;
+		status = 2;
+	}
+
+	if (!traceFile.empty())
+	{
+		std::ofstream os(traceFile);
+
+		trace::dump(os);
 	}
-	return 0;
-}
\ No newline at end of file
+	return status;
+}
@@ -1,30 +1,55 @@
-// stdafx.h : include file for standard system include files,
-// or project specific include files that are used frequently, but
-// are changed infrequently
-//
-
-#pragma once
-
-#include "targetver.h"
-
-#include <stdio.h>
-// #include <tchar.h>
-
-// Input/Output
-#include <sstream>
-#include <fstream>
-#include <iostream>
-
-// Lexer
-#include <cctype>
-#include "Token.hpp"
-#include "Tokenizer.hpp"
-
-// Parser
-#include "Parser.hpp"
-
-// Error
-#include <cassert>
-#include "Syntax.hpp"
-
-// TODO: reference additional headers your program requires here
+// stdafx.h : include file for standard system include files,
+// or project specific include files that are used frequently, but
+// are changed infrequently
+//
+
+#pragma once
+
+#include "targetver.h"
+
+#include <stdio.h>
+// #include <tchar.h>
+
+// Input/Output
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+// Lexer
+#include <cctype>
+#include "Source.hpp"
+#include "Token.hpp"
+#include "Charset.hpp"
+#include "Keyword.hpp"
+#include "Interner.hpp"
+#include "Scan.hpp"
+#include "Trivia.hpp"
+#include "Tokenizer.hpp"
+
+// Parser
+#include "Ast.hpp"
+#include "Parser.hpp"
+
+// Output
+#include "Hash.hpp"
+#include "Sink.hpp"
+#include "Emitter.hpp"
+#include "MappedAst.hpp"
+
+// Driver
+#include "Input.hpp"
+#include "ThreadPool.hpp"
+#include "ParseCache.hpp"
+#include "Driver.hpp"
+#include "Resolve.hpp"
+#include "Project.hpp"
+
+// Error
+#include <cassert>
+#include "Diagnostic.hpp"
+#include "Syntax.hpp"
+
+// Debug
+#include "Trace.hpp"
+
+// TODO: reference additional headers your program requires here
@@ -0,0 +1,666 @@
+// main.cpp : Regression tests of the parser, run as a console program.
+// Returns 0 when every test passes, 1 otherwise.
+//
+
+#include "stdafx.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace nope::dts::parser;
+
+namespace
+{
+	int g_failures = 0;
+
+	void check(bool condition, std::string_view test, std::string_view what)
+	{
+		if (!condition)
+		{
+			std::cerr << test << ": " << what << std::endl;
+			++g_failures;
+		}
+	}
+
+	// An empty directory of the given name, in the temporary directory
+	std::filesystem::path scratch(std::string_view name)
+	{
+		std::filesystem::path const path = std::filesystem::temp_directory_path() / ("tsdparser-" + std::string(name));
+
+		std::filesystem::remove_all(path);
+		std::filesystem::create_directories(path);
+		return path;
+	}
+
+	std::string json(Ast const &ast)
+	{
+		std::string output;
+
+		{
+			StringSink sink(output);
+			JsonEmitter emitter(sink);
+
+			emitter.write(ast);
+			sink.flush();
+		}
+		return output;
+	}
+
+	void write(std::filesystem::path const &path, std::string_view text)
+	{
+		std::filesystem::create_directories(path.parent_path());
+		FdSink(path.string()).write(text);
+	}
+
+	// The nodes of a tree in document order, with their value and number of children
+	template<typename Tree>
+	std::vector<std::tuple<TokenType, std::string_view, std::uint32_t>> nodes(Tree const &tree)
+	{
+		std::vector<std::tuple<TokenType, std::string_view, std::uint32_t>> list;
+		std::vector<NodeId> stack;
+
+		if (tree.root() != Ast::none)
+		{
+			stack.push_back(tree.root());
+		}
+		while (!stack.empty())
+		{
+			NodeId const id = stack.back();
+			std::size_t const children = stack.size() - 1;
+
+			stack.pop_back();
+			list.emplace_back(tree.type(id), tree.value(id), tree.childCount(id));
+			for (NodeId c = tree.firstChild(id); c != Ast::none; c = tree.nextSibling(c))
+			{
+				stack.push_back(c);
+			}
+			std::reverse(stack.begin() + children, stack.end());
+		}
+		return list;
+	}
+
+	std::string binary(Ast const &ast)
+	{
+		std::string output;
+
+		{
+			StringSink sink(output);
+			BinaryEmitter emitter(sink);
+
+			emitter.write(ast);
+			sink.flush();
+		}
+		return output;
+	}
+
+	// Whether loading a tree file fails, for the reason given
+	bool rejected(std::string data, std::string_view reason)
+	{
+		try
+		{
+			MappedAst tree(Source::own(std::move(data), "tree.bin"));
+		}
+		catch (std::runtime_error const &e)
+		{
+			return std::string_view(e.what()).find(reason) != std::string_view::npos;
+		}
+		return false;
+	}
+
+	// An edit after a failed parse must not be spliced into the broken tree
+	void editAfterFailure()
+	{
+		std::string const text = "declare var a: string;\ndeclare var b: ;\ndeclare var c: string;\n";
+		std::size_t const type = text.find("string");
+		Parser parser(Source::own(text, "edit.d.ts"));
+		bool thrown = false;
+
+		check(!parser.tryParse(), __func__, "the input has an error");
+		try
+		{
+			parser.edit(static_cast<std::uint32_t>(type), 6, "number");
+		}
+		catch (error::Syntax const &)
+		{
+			thrown = true;
+		}
+		check(thrown, __func__, "an edit leaving the error in is reported");
+		check(!parser.diagnostics().empty(), __func__, "the error is still diagnosed");
+	}
+
+	void editFixingFailure()
+	{
+		std::string text = "declare var a: string;\ndeclare var b: ;\ndeclare var c: string;\n";
+		std::size_t const hole = text.find(": ;") + 2;
+		Parser parser(Source::own(text, "edit.d.ts"));
+
+		check(!parser.tryParse(), __func__, "the input has an error");
+		check(!parser.edit(static_cast<std::uint32_t>(hole), 0, "number"), __func__, "the whole input is parsed again");
+		check(parser.diagnostics().empty(), __func__, "the error is gone");
+
+		Parser full(Source::own(text.insert(hole, "number"), "edit.d.ts"));
+
+		full.parse();
+		check(parser.ast().json() == full.ast().json(), __func__, "the tree is the one of a full parse");
+	}
+
+	// Each edit leaves the replaced nodes behind, until the arena is compacted
+	void editManyTimes()
+	{
+		std::string text = "declare var a: string;\ndeclare var b: string;\ndeclare var c: string;\n";
+		std::size_t const type = text.find("string", text.find("b:"));
+		Parser parser(Source::own(text, "edit.d.ts"));
+
+		parser.parse();
+
+		std::size_t const initial = parser.ast().ast().size();
+		bool incremental = true;
+		bool bounded = true;
+
+		for (int i = 0; i < 500; ++i)
+		{
+			char const *name = i % 2 == 0 ? "number" : "string";
+
+			incremental = parser.edit(static_cast<std::uint32_t>(type), 6, name) && incremental;
+			bounded = parser.ast().ast().size() <= 3 * initial && bounded;
+			text.replace(type, 6, name);
+		}
+		check(incremental, __func__, "every edit is incremental");
+		check(bounded, __func__, "the arena does not grow with the edits");
+
+		Parser full(Source::own(text, "edit.d.ts"));
+
+		full.parse();
+		check(parser.ast().json() == full.ast().json(), __func__, "the tree is the one of a full parse");
+	}
+
+	// Stray characters end up in an Error node, and are written back like any token
+	void recoverUnknown()
+	{
+		std::string const text = "declare var a: string;\ndeclare var b: # \xE2\x82\xAC;\ndeclare var c: number;\n";
+		Parser parser(Source::own(text, "unknown.d.ts"));
+
+		parser.setRecovery(true);
+		check(!parser.tryParse(), __func__, "the input has an error");
+		check(parser.diagnostics().size() == 1, __func__, "the error is diagnosed once");
+
+		std::string const code = parser.ast().code();
+		std::string const json = parser.ast().json();
+
+		check(code.find("declare var b : # \xE2\x82\xAC ; declare var c : number ;") != std::string::npos, __func__,
+			"the code keeps the stray characters");
+		check(json.find("{\"type\":\"UNKNOWN\", \"value\":\"#\"}") != std::string::npos, __func__,
+			"the JSON holds the value of a stray character");
+	}
+
+	void globMatch()
+	{
+		struct Case
+		{
+			char const *pattern;
+			char const *path;
+			bool matches;
+		};
+
+		Case const cases[] = {
+			// "**/" matches any number of directories, none included
+			{ "**/*.d.ts", "a.d.ts", true },
+			{ "**/*.d.ts", "x/y/a.d.ts", true },
+			{ "src/**/a.d.ts", "src/a.d.ts", true },
+			{ "src/**/a.d.ts", "src/x/y/a.d.ts", true },
+			{ "src/**/a.d.ts", "lib/x/a.d.ts", false },
+			{ "a/**/b/*.ts", "a/b/c.ts", true },
+			{ "a/**/b/*.ts", "a/x/b/y/c.ts", false },
+			// '*' and '?' do not cross a '/'
+			{ "*.d.ts", "a.d.ts", true },
+			{ "*.d.ts", "x/a.d.ts", false },
+			{ "x/*.d.ts", "x/a.d.ts", true },
+			{ "*", "a/b", false },
+			{ "a*b*c", "aXbYc", true },
+			{ "a*b*c", "aXbY/c", false },
+			{ "a?c", "abc", true },
+			{ "a?c", "a/c", false },
+			{ "a?c", "ac", false },
+			// Sets and ranges
+			{ "[abc].d.ts", "b.d.ts", true },
+			{ "[abc].d.ts", "d.d.ts", false },
+			{ "[a-c]x", "bx", true },
+			{ "[a-c]x", "dx", false },
+			{ "[a-]x", "-x", true },
+			{ "x[a-z]/y", "x/y", false },
+			// A trailing "**" matches everything below
+			{ "src/**", "src/a/b.d.ts", true },
+			{ "src/**", "other/a.d.ts", false },
+			{ "**", "a/b/c", true },
+			// A '[' with no closing ']' is a plain character
+			{ "a[b", "a[b", true },
+			{ "a[b", "ab", false },
+			{ "", "", true },
+			{ "", "a", false }
+		};
+
+		for (auto const &c : cases)
+		{
+			check(input::match(c.pattern, c.path) == c.matches, __func__,
+				std::string(c.pattern) + (c.matches ? " matches " : " does not match ") + c.path);
+		}
+	}
+
+	// Tokens compare by name, wherever they are
+	void tokenNames()
+	{
+		Tokenizer first(Source::own("foo bar \"x\"", "first.d.ts"));
+		Tokenizer second(Source::own("  foo   \"x\" \"y\"", "second.d.ts"));
+		Token const foo = first.next();
+		Token const bar = first.next();
+		Token const x = first.next();
+		Token const otherFoo = second.next();
+		Token const otherX = second.next();
+		Token const y = second.next();
+
+		check(foo == otherFoo, __func__, "the same name at another offset of another file is equal");
+		check(foo != bar, __func__, "another name is not");
+		check((foo < bar) != (bar < foo), __func__, "names are ordered");
+		check(x.sameText(otherX, first.source(), second.source()), __func__, "literals compare by their bytes");
+		check(!x.sameText(y, first.source(), second.source()), __func__, "other bytes are another text");
+		check(foo.sameText(otherFoo, first.source(), second.source()), __func__, "names compare by symbol");
+	}
+
+	// A parse given its own interner leaves the shared one alone
+	void scopedInterner()
+	{
+		std::size_t const shared = Interner::shared().size();
+		Interner::Cache cache;
+
+		{
+			Interner batch;
+			Parser parser(Source::own("declare var someName: OtherName;", "scoped.d.ts"));
+
+			parser.setInterner(batch);
+			parser.parse();
+			check(batch.size() == Interner::global + 3, __func__, "the names go to the interner given");
+			check(Interner::shared().size() == shared, __func__, "the shared interner does not grow");
+			batch.intern("cached", cache);
+		}
+
+		// The cache must not hand out a name of the interner gone
+		Interner next;
+		Symbol symbol = next.intern("cached", cache);
+
+		check(next.name(symbol) == "cached" && symbol == Interner::global + 1, __func__,
+			"a cache used with another interner starts over");
+	}
+
+	void emitEmpty()
+	{
+		Ast const ast;
+		std::string output;
+
+		{
+			StringSink sink(output);
+			JsonEmitter json(sink);
+
+			json.write(ast);
+			sink.flush();
+		}
+		check(output.empty(), __func__, "an empty tree writes nothing");
+	}
+
+	char const g_sample[] =
+		"/// <reference path=\"other.d.ts\" />\n"
+		"declare namespace N {\n"
+		"\tinterface I<T> extends J { a?: T[]; (x: number): string; [k: string]: any; }\n"
+		"\ttype U = 'a' | \"b\" | 42 | { b: () => void };\n"
+		"}\n"
+		"export function f(...rest: string[]): N.I<number>;\n";
+
+	// A tree written by BinaryEmitter reads back the same, mapped or unpacked
+	void binaryRoundTrip()
+	{
+		Parser parser(Source::own(g_sample, "sample.d.ts"));
+
+		parser.parse();
+
+		Ast const &ast = parser.ast().ast();
+		MappedAst mapped(Source::own(binary(ast), "sample.bin"));
+		Ast unpacked;
+
+		check(mapped.source() == ast.source(), __func__, "the file holds the source");
+		check(nodes(mapped) == nodes(ast), __func__, "the mapped tree has the nodes of the tree written");
+		mapped.unpack(unpacked);
+		check(nodes(unpacked) == nodes(ast), __func__, "the unpacked tree has the nodes of the tree written");
+		check(json(unpacked) == json(ast), __func__, "the unpacked tree writes the same JSON");
+		check(binary(unpacked) == mapped.data(), __func__, "the unpacked tree writes the same file");
+	}
+
+	void binaryCorrupted()
+	{
+		Parser parser(Source::own(g_sample, "sample.d.ts"));
+
+		parser.parse();
+
+		std::string const data = binary(parser.ast().ast());
+		std::size_t const count = parser.ast().ast().size();
+		std::size_t const ends = sizeof(MappedAst::Header) + 3 * count * sizeof(std::uint32_t);
+
+		check(!rejected(data, ""), __func__, "the file written is valid");
+		for (std::size_t at : { std::size_t(0), sizeof(MappedAst::Header) + 1, ends + 5, data.size() - 20, data.size() - 1 })
+		{
+			std::string flipped = data;
+
+			flipped[at] ^= 0x10;
+			check(rejected(flipped, ""), __func__, "a flipped byte at " + std::to_string(at) + " is rejected");
+		}
+
+		std::string flipped = data;
+
+		flipped[sizeof(MappedAst::Header) + 1] ^= 0x10;
+		check(rejected(flipped, "checksum mismatch"), __func__, "a flipped byte fails the checksum");
+
+		// With the checksum matching, only the checks of the nodes catch it
+		std::string corrupted = data;
+		std::uint32_t const end = static_cast<std::uint32_t>(count + 1);
+		std::uint64_t checksum;
+
+		std::memcpy(&corrupted[ends], &end, sizeof(end));
+		checksum = hash::of(std::string_view(corrupted).substr(0, corrupted.size() - sizeof(checksum)));
+		std::memcpy(&corrupted[corrupted.size() - sizeof(checksum)], &checksum, sizeof(checksum));
+		check(rejected(corrupted, "corrupted node"), __func__, "a subtree ending past the last node is rejected");
+	}
+
+	void packageTypes()
+	{
+		struct Case
+		{
+			char const *json;
+			char const *types;
+		};
+
+		Case const cases[] = {
+			{ "{\"name\": \"x\", \"types\": \"lib/x.d.ts\"}", "lib/x.d.ts" },
+			{ "{\"typings\": \"x.d.ts\"}", "x.d.ts" },
+			{ "{\"typings\": \"old.d.ts\", \"types\": \"new.d.ts\"}", "new.d.ts" },
+			{ "{\"types\": \"new.d.ts\", \"typings\": \"old.d.ts\"}", "new.d.ts" },
+			// Only the keys of the top level count
+			{ "{\"exports\": {\"types\": \"nested.d.ts\"}}", "" },
+			{ "{\"exports\": {\"types\": \"nested.d.ts\"}, \"typings\": \"x.d.ts\"}", "x.d.ts" },
+			{ "{\"files\": [\"types\", \"a.d.ts\"], \"types\": \"x.d.ts\"}", "x.d.ts" },
+			// Nor is a value a key
+			{ "{\"main\": \"types\", \"x\": \"y.d.ts\"}", "" },
+			// An escaped quote does not end a string
+			{ "{\"description\": \"no \\\"types\\\": \\\"a.d.ts\\\"\", \"types\": \"x.d.ts\"}", "x.d.ts" },
+			{ "{\"types\": \"a\\\"b.d.ts\"}", "a\\\"b.d.ts" },
+			{ "{\"types\": \"x.d.ts", "" },
+			{ "", "" }
+		};
+
+		for (auto const &c : cases)
+		{
+			check(resolve::packageTypes(c.json) == c.types, __func__, std::string(c.json) + " has types " + c.types);
+		}
+	}
+
+	void isRelative()
+	{
+		for (char const *specifier : { ".", "..", "./a", "../a", "./", "/a/b" })
+		{
+			check(resolve::isRelative(specifier), __func__, std::string(specifier) + " is a path");
+		}
+		for (char const *specifier : { "a", "a/b", "@scope/a", ".a", "..a", "" })
+		{
+			check(!resolve::isRelative(specifier), __func__, std::string(specifier) + " is a package name");
+		}
+	}
+
+	void resolveTypes()
+	{
+		std::filesystem::path const directory = scratch("resolve-types");
+		std::filesystem::path const from = directory / "src" / "a.d.ts";
+		std::filesystem::path const scoped = directory / "node_modules" / "@types" / "scope__name" / "index.d.ts";
+		std::filesystem::path const plain = directory / "node_modules" / "@types" / "plain" / "index.d.ts";
+
+		write(from, "");
+		write(scoped, "");
+		write(plain, "");
+		check(resolve::types("@scope/name", from.string()) == scoped.string(), __func__,
+			"@scope/name is looked up as @types/scope__name");
+		check(resolve::module("@scope/name", from.string()) == scoped.string(), __func__,
+			"a module falls back to @types likewise");
+		check(resolve::types("plain", from.string()) == plain.string(), __func__, "a plain name is looked up as is");
+		check(resolve::types("scope__name", from.string()) == scoped.string(), __func__,
+			"the name under @types is found as well");
+		check(resolve::types("@scope/other", from.string()).empty(), __func__, "a package not installed is not found");
+		std::filesystem::remove_all(directory);
+	}
+
+	// The imports and references of the files are followed, each file parsed once
+	void projectCrawl()
+	{
+		std::filesystem::path const directory = scratch("project");
+		std::filesystem::path const modules = directory / "node_modules";
+		Options options;
+
+		write(directory / "root.d.ts",
+			"/// <reference path='lib/ref.d.ts' />\n"
+			"/// <reference types='@scope/name'/>\n"
+			"import { A } from \"./a\";\n"
+			"import { P } from \"pkg\";\n"
+			"import { M } from \"missing\";\n");
+		write(directory / "a.d.ts",
+			"/// <reference path = \"lib/ref.d.ts\"/>\n"
+			"import { P } from \"pkg\";\n"
+			"import { R } from \"./root\";\n"
+			"export interface A { p: P; }\n");
+		write(directory / "lib" / "ref.d.ts", "declare var ref: number;\n");
+		write(modules / "pkg" / "package.json", "{\"exports\": {\"types\": \"wrong.d.ts\"}, \"typings\": \"types/main.d.ts\"}");
+		write(modules / "pkg" / "types" / "main.d.ts", "export interface P { }\n");
+		write(modules / "@types" / "scope__name" / "index.d.ts", "declare var scoped: string;\n");
+
+		options.output = (directory / "graph.json").string();
+		options.jobs = 2;
+
+		Project project(options);
+
+		check(project.run({ (directory / "root.d.ts").string() }) == 0, __func__, "every file parses");
+
+		std::map<std::string, std::size_t> files;
+
+		for (std::size_t i = 0; i < project.files().size(); ++i)
+		{
+			Project::File const &file = project.files()[i];
+
+			files.emplace(std::filesystem::path(file.path).lexically_relative(directory).generic_string(), i);
+			check(file.ok, __func__, file.path + " parses");
+		}
+		check(files.size() == project.files().size(), __func__, "no file is parsed twice");
+		check(files.size() == 5, __func__, "the closure has five files");
+
+		// Index of the file an import of a file resolves to, none if unresolved or absent
+		auto target = [&](std::string const &path, std::string const &specifier)
+		{
+			auto file = files.find(path);
+
+			if (file != files.end())
+			{
+				for (auto const &import : project.files()[file->second].imports)
+				{
+					if (import.specifier == specifier)
+					{
+						return import.file;
+					}
+				}
+			}
+			return Project::none;
+		};
+		auto index = [&](std::string const &path)
+		{
+			auto file = files.find(path);
+
+			// Not none either, a file missing must fail the checks
+			return file != files.end() ? file->second : Project::none - 1;
+		};
+
+		check(target("root.d.ts", "lib/ref.d.ts") == index("lib/ref.d.ts"), __func__, "a path in single quotes is followed");
+		check(target("root.d.ts", "@scope/name") == index("node_modules/@types/scope__name/index.d.ts"), __func__,
+			"types in single quotes are followed");
+		check(target("root.d.ts", "./a") == index("a.d.ts"), __func__, "a relative import is followed");
+		check(target("root.d.ts", "pkg") == index("node_modules/pkg/types/main.d.ts"), __func__,
+			"a package is found in node_modules");
+		check(target("root.d.ts", "missing") == Project::none, __func__, "a package not installed is left out");
+		check(target("a.d.ts", "lib/ref.d.ts") == index("lib/ref.d.ts"), __func__, "a file referenced twice is shared");
+		check(target("a.d.ts", "pkg") == index("node_modules/pkg/types/main.d.ts"), __func__,
+			"a package imported twice is shared");
+		check(target("a.d.ts", "./root") == index("root.d.ts"), __func__, "a cycle leads back to the root");
+		std::filesystem::remove_all(directory);
+	}
+
+	void cacheStoreFind()
+	{
+		std::filesystem::path const directory = scratch("cache-find");
+		std::string const text = "declare var a: string;\ndeclare var b: ;\n";
+		Parser parser(Source::own(text, "cached.d.ts"));
+		bool const ok = parser.tryParse();
+		std::uint64_t const key = ParseCache::key(hash::of(text), false);
+
+		{
+			ParseCache cache(directory.string(), 0);
+
+			cache.store(key, parser.ast().ast(), parser.diagnostics(), ok, false);
+
+			auto entry = cache.find(key, text, "other.d.ts");
+			Ast ast;
+
+			check(entry != nullptr, __func__, "a stored content is found");
+			if (entry)
+			{
+				entry->tree.unpack(ast);
+				check(entry->ok == ok, __func__, "the entry keeps whether the parse succeeded");
+				check(entry->diagnostics.size() == 1 && entry->diagnostics[0].line == 2 &&
+					entry->diagnostics[0].message == parser.diagnostics()[0].message, __func__, "the entry keeps the diagnostics");
+				check(entry->diagnostics.size() == 1 && entry->diagnostics[0].file == "other.d.ts", __func__,
+					"the diagnostics are given the name looked up");
+				check(json(ast) == parser.ast().json(), __func__, "the entry holds the tree");
+			}
+			check(cache.stats().stored == 1 && cache.stats().hits == 1, __func__, "the store and the hit are counted");
+		}
+		std::filesystem::remove_all(directory);
+	}
+
+	// The entries are keyed by a hash, another content under the same key is not the one stored
+	void cacheOtherContent()
+	{
+		std::filesystem::path const directory = scratch("cache-other");
+		std::string const text = "declare var a: string;";
+		Parser parser(Source::own(text, "cached.d.ts"));
+		std::uint64_t const key = ParseCache::key(hash::of(text), false);
+
+		parser.parse();
+		{
+			ParseCache cache(directory.string(), 0);
+
+			cache.store(key, parser.ast().ast(), parser.diagnostics(), true, false);
+			check(cache.find(key, "declare var b: string;", "other.d.ts") == nullptr, __func__,
+				"a content of the same size is a miss");
+			check(cache.find(key, "declare var a: string; ", "other.d.ts") == nullptr, __func__,
+				"a content of another size is a miss");
+			check(cache.find(ParseCache::key(hash::of(text), true), text, "other.d.ts") == nullptr, __func__,
+				"a parse in another mode is a miss");
+			check(cache.stats().misses == 3 && cache.stats().hits == 0, __func__, "the misses are counted");
+		}
+		std::filesystem::remove_all(directory);
+	}
+
+	void cacheEvict()
+	{
+		std::filesystem::path const directory = scratch("cache-evict");
+		std::string const texts[] = {
+			"declare var a: string;",
+			"declare var b: string;",
+			"declare var c: string;"
+		};
+		std::uint64_t keys[3];
+		std::uintmax_t total = 0;
+
+		{
+			ParseCache cache(directory.string(), 0);
+
+			for (std::size_t i = 0; i < 3; ++i)
+			{
+				Parser parser(Source::own(texts[i], "cached.d.ts"));
+
+				parser.parse();
+				keys[i] = ParseCache::key(hash::of(texts[i]), false);
+				cache.store(keys[i], parser.ast().ast(), parser.diagnostics(), true, false);
+			}
+			// All written an hour ago, then the last two used
+			for (auto const &file : std::filesystem::directory_iterator(directory))
+			{
+				std::filesystem::last_write_time(file.path(),
+					std::filesystem::file_time_type::clock::now() - std::chrono::hours(1));
+				total += file.file_size();
+			}
+			check(cache.find(keys[1], texts[1], "b.d.ts") && cache.find(keys[2], texts[2], "c.d.ts"), __func__,
+				"the entries are stored");
+		}
+
+		// The entries have the same size, all but one fit
+		ParseCache cache(directory.string(), total - 1);
+
+		cache.evict();
+		check(cache.stats().evicted == 1, __func__, "a single entry is evicted");
+		check(cache.find(keys[0], texts[0], "a.d.ts") == nullptr, __func__, "the least recently used entry is evicted");
+		check(cache.find(keys[1], texts[1], "b.d.ts") && cache.find(keys[2], texts[2], "c.d.ts"), __func__,
+			"the others are kept");
+		std::filesystem::remove_all(directory);
+	}
+
+	struct Test
+	{
+		char const *name;
+		std::function<void()> run;
+	};
+}
+
+int main()
+{
+	Test const tests[] = {
+		{ "editAfterFailure", editAfterFailure },
+		{ "editFixingFailure", editFixingFailure },
+		{ "editManyTimes", editManyTimes },
+		{ "recoverUnknown", recoverUnknown },
+		{ "globMatch", globMatch },
+		{ "tokenNames", tokenNames },
+		{ "scopedInterner", scopedInterner },
+		{ "emitEmpty", emitEmpty },
+		{ "binaryRoundTrip", binaryRoundTrip },
+		{ "binaryCorrupted", binaryCorrupted },
+		{ "packageTypes", packageTypes },
+		{ "isRelative", isRelative },
+		{ "resolveTypes", resolveTypes },
+		{ "projectCrawl", projectCrawl },
+		{ "cacheStoreFind", cacheStoreFind },
+		{ "cacheOtherContent", cacheOtherContent },
+		{ "cacheEvict", cacheEvict }
+	};
+
+	for (auto const &test : tests)
+	{
+		try
+		{
+			test.run();
+		}
+		catch (std::exception const &e)
+		{
+			check(false, test.name, e.what());
+		}
+	}
+	std::cout << (g_failures == 0 ? "All tests passed" : "Some tests failed") << std::endl;
+	return g_failures == 0 ? 0 : 1;
+}